@@ -0,0 +1,183 @@
+/*
+    Benchmarks for the hot paths of the library. Built and run with 'make bench' in the repository root.
+    Usage: bench [filter] [--min-time <seconds>] [--repetitions <n>]
+*/
+#include <string>
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "bench.h"
+
+#include "gcheck.h"
+#include "customtest.h"
+#include "multiprocessing.h"
+#include "shared_allocator.h"
+#include "redirectors.h"
+#include "stringify.h"
+#include "json.h"
+
+#ifndef GCHECK_BENCH_VERSION
+#define GCHECK_BENCH_VERSION "unknown"
+#endif
+
+using namespace gcheck;
+
+namespace {
+
+FunctionEntry MakeEntry(int i) {
+    FunctionEntry entry;
+    entry.arguments = UserObject(std::tuple(i, std::string("argument")));
+    entry.arguments_after = entry.arguments;
+    entry.arguments_after_expected = entry.arguments;
+    entry.return_value = UserObject(i*2);
+    entry.return_value_expected = UserObject(i*2);
+    entry.run_time = std::chrono::nanoseconds(1000 + i);
+    entry.timeout = std::chrono::duration<double>(0);
+    entry.result = i % 7 != 0;
+    return entry;
+}
+
+BENCHMARK("run_forked/round_trip", [](size_t n) {
+    FunctionEntry entry = MakeEntry(1);
+    return bench::Time(n, [&]() {
+        RunForked(std::chrono::duration<double>(0), entry, 1024*1024, [&]() { entry.result = true; });
+    });
+}, 0, 256);
+
+// The free list isn't coalesced, so blocks are allocated from a fresh manager and freed after timing
+BENCHMARK("shared_manager/allocate_64", [](size_t n) {
+    shared_manager sm(n*64);
+    std::vector<void*> blocks(n);
+    auto time = bench::Time(n, [&, i = 0]() mutable {
+        blocks[i] = sm.allocate(64);
+        bench::DoNotOptimize(blocks[i++]);
+    });
+    for(auto p : blocks)
+        sm.deallocate(p, 64);
+    return time;
+}, 0, 1 << 20);
+
+const size_t io_size = 64*1024;
+
+BENCHMARK("capturer/stdout_64k", [](size_t n) {
+    std::string data(io_size, 'x');
+    StdoutCapturer capturer(false);
+    return bench::Time(n, [&]() {
+        capturer.Capture();
+        fwrite(data.data(), 1, data.length(), stdout);
+        capturer.Restore();
+        bench::DoNotOptimize(capturer.str());
+    });
+}, io_size);
+
+BENCHMARK("injecter/stdin_64k", [](size_t n) {
+    std::string data(io_size, 'x');
+    std::vector<char> buffer(io_size);
+    StdinInjecter injecter(false);
+    return bench::Time(n, [&]() {
+        injecter.Capture();
+        injecter.Write(data);
+        size_t read = fread(buffer.data(), 1, buffer.size(), stdin);
+        bench::DoNotOptimize(read);
+        injecter.Restore();
+    });
+}, io_size);
+
+BENCHMARK("json_escape/4k", [](size_t n) {
+    std::string str;
+    while(str.length() < 4096)
+        str += "line with \"quotes\", a \\ and\ttabs\n";
+    return bench::Time(n, [&]() { bench::DoNotOptimize(JSONEscape(str)); });
+}, 4096);
+
+BENCHMARK("to_string/vector_int_100k", [](size_t n) {
+    std::vector<int> v(100000);
+    for(size_t i = 0; i < v.size(); i++)
+        v[i] = i*37;
+    return bench::Time(n, [&]() { bench::DoNotOptimize(toString(v)); });
+});
+
+BENCHMARK("to_string/vector_pair_string_double_10k", [](size_t n) {
+    std::vector<std::pair<std::string, double>> v;
+    for(int i = 0; i < 10000; i++)
+        v.emplace_back("key" + std::to_string(i), i/3.0);
+    return bench::Time(n, [&]() { bench::DoNotOptimize(toString(v)); });
+});
+
+BENCHMARK("json/test_data_1000_runs", [](size_t n) {
+    TestData data(1, Prerequisite());
+    TestReport report = TestReport::Make<FunctionData>();
+    auto& runs = report.Get<FunctionData>();
+    for(int i = 0; i < 1000; i++)
+        runs.Add(MakeEntry(i));
+    data.reports.push_back(report);
+    return bench::Time(n, [&]() { bench::DoNotOptimize(JSON(data)); });
+});
+
+class SyntheticTest : public CustomTest {
+    void TheTest() override { ExpectTrue(true, "synthetic"); }
+public:
+    SyntheticTest(const TestInfo& info) : CustomTest(info) {}
+};
+
+/*
+    Test::RunTests can run only once per process, so each repetition registers the tests in a child process
+    and times RunTests there. Every second test depends on the one before it.
+*/
+const size_t synthetic_tests = 1000;
+
+BENCHMARK("run_tests/1000_tests", [](size_t n) {
+    bench::Duration total(0);
+    for(size_t i = 0; i < n; i++) {
+        int fds[2];
+        if(pipe(fds) != 0)
+            return total;
+        pid_t pid = fork();
+        if(pid == 0) {
+            close(fds[0]);
+            int null = open("/dev/null", O_RDWR);
+            dup2(null, STDOUT_FILENO);
+            dup2(null, STDIN_FILENO);
+
+            std::vector<std::unique_ptr<SyntheticTest>> tests;
+            for(size_t t = 0; t < synthetic_tests; t++) {
+                std::string name = "test" + std::to_string(t);
+                std::string prerequisite = t % 2 ? "test" + std::to_string(t-1) : "";
+                tests.emplace_back(new SyntheticTest(TestInfo("suite" + std::to_string(t/100), name, 1, prerequisite)));
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            Test::RunTests();
+            int64_t ns = (std::chrono::steady_clock::now() - start).count();
+            ssize_t written = write(fds[1], &ns, sizeof(ns));
+            _exit(written == sizeof(ns) ? 0 : 1);
+        }
+        close(fds[1]);
+        int64_t ns = 0;
+        if(read(fds[0], &ns, sizeof(ns)) != sizeof(ns))
+            ns = 0;
+        close(fds[0]);
+        waitpid(pid, NULL, 0);
+        total += bench::Duration(ns);
+    }
+    return total;
+}, 0, 8);
+
+} // anonymous
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double min_time = 0.2;
+    int repetitions = 5;
+    for(int i = 1; i < argc; i++) {
+        if(argv[i] == std::string("--min-time") && i+1 < argc) min_time = std::stod(argv[++i]);
+        else if(argv[i] == std::string("--repetitions") && i+1 < argc) repetitions = std::stoi(argv[++i]);
+        else filter = argv[i];
+    }
+
+    bench::RunAll(filter, GCHECK_BENCH_VERSION, std::chrono::duration_cast<bench::Duration>(std::chrono::duration<double>(min_time)), repetitions);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+
+/*
+    Minimal benchmark runner. Each benchmark is a function that does 'n' operations and returns
+    the time they took, so setup can be left out of the measurement. The number of operations is
+    doubled until a repetition takes at least min_time, then the repetitions are run and the results
+    are printed to stdout as one JSON object per line.
+*/
+namespace bench {
+
+typedef std::chrono::nanoseconds Duration;
+typedef std::function<Duration(size_t n)> Function;
+
+struct Benchmark {
+    std::string name;
+    Function function;
+    size_t bytes_per_op; // for throughput benchmarks, 0 otherwise
+    size_t max_ops; // upper limit for the number of operations per repetition, 0 for none
+};
+
+inline std::vector<Benchmark>& Registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Register {
+    Register(std::string name, Function function, size_t bytes_per_op = 0, size_t max_ops = 0) {
+        Registry().push_back({name, function, bytes_per_op, max_ops});
+    }
+};
+
+// Times 'body' called 'n' times
+template<typename F>
+Duration Time(size_t n, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; i++)
+        body();
+    return std::chrono::steady_clock::now() - start;
+}
+
+// Keeps the compiler from optimizing 'value' away
+template<typename T>
+void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline std::string Escape(const std::string& str) {
+    std::string out;
+    for(char c : str) {
+        if(c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+/*
+    Runs the benchmarks whose name contains 'filter' and prints a line for each:
+    {"benchmark": name, "version": version, "ops": n, "repetitions": r, "ns_per_op": median, "min_ns_per_op": min, "mb_per_s": ...}
+*/
+inline void RunAll(const std::string& filter, const std::string& version, Duration min_time, int repetitions) {
+    for(auto& b : Registry()) {
+        if(b.name.find(filter) == std::string::npos)
+            continue;
+
+        size_t n = 1;
+        while(b.function(n) < min_time && (b.max_ops == 0 || n < b.max_ops))
+            n *= 2;
+        if(b.max_ops != 0)
+            n = std::min(n, b.max_ops);
+
+        std::vector<double> per_op;
+        for(int i = 0; i < repetitions; i++)
+            per_op.push_back(double(b.function(n).count())/n);
+        std::sort(per_op.begin(), per_op.end());
+        double median = per_op[per_op.size()/2];
+
+        std::printf("{\"benchmark\": \"%s\", \"version\": \"%s\", \"ops\": %zu, \"repetitions\": %d, \"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f",
+                Escape(b.name).c_str(), Escape(version).c_str(), n, repetitions, median, per_op[0]);
+        if(b.bytes_per_op != 0)
+            std::printf(", \"mb_per_s\": %.1f", b.bytes_per_op/median*1e9/1e6);
+        std::printf("}\n");
+        std::fflush(stdout);
+    }
+}
+
+} // bench
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+// params: name, function taking the number of operations and returning their duration, bytes per operation (optional), max operations (optional)
+#define BENCHMARK(...) \
+    static bench::Register BENCH_CONCAT(bench_register_, __LINE__)(__VA_ARGS__)
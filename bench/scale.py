@@ -0,0 +1,223 @@
+#!/usr/bin/python3
+"""
+End-to-end scale benchmark. Generates a test suite with many suites, prerequisite chains,
+FUNCTIONTESTs with many runs, IOTESTs with large inputs and outputs and TESTs, builds it
+against the library in lib/ and runs it. Reports for every mode
+ - the wall time of the whole run,
+ - the harness overhead per run, i.e. the wall time not spent in the tested functions divided by the number of runs,
+ - the peak RSS of the harness process and
+ - the size of the report.
+The default sizes are 10000 tests and about 1000000 runs. The --safe mode forks for every run,
+so it runs the same suite with the number of runs divided by --safe-divisor.
+Run with 'make bench-scale' in the repository root, e.g. make bench-scale SCALE_ARGS="--tests 20".
+"""
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+root = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+sys.path.insert(0, os.path.join(root, "tools"))
+from report_parser import load_report
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--cxx", dest='cxx', type=str, default=os.environ.get("CXX", "g++"))
+parser.add_argument("--cxxflags", dest='cxxflags', type=str, default="-O2", help="compiler flags for the generated suite")
+parser.add_argument("--suites", dest='suites', type=int, default=100, help="number of suites")
+parser.add_argument("--tests", dest='tests', type=int, default=100, help="number of tests per suite")
+parser.add_argument("--total-runs", dest='total_runs', type=int, default=1000000, help="runs in all of the tests, divided between the FUNCTIONTESTs")
+parser.add_argument("--chain", dest='chain', type=int, default=25, help="length of the prerequisite chains in a suite")
+parser.add_argument("--io-every", dest='io_every', type=int, default=5, help="every nth test is an IOTEST")
+parser.add_argument("--io-runs", dest='io_runs', type=int, default=20, help="runs per IOTEST")
+parser.add_argument("--io-size", dest='io_size', type=int, default=64*1024, help="bytes of input and output per IOTEST run")
+parser.add_argument("--custom-every", dest='custom_every', type=int, default=10, help="every nth test is a TEST")
+parser.add_argument("--safe-divisor", dest='safe_divisor', type=int, default=100, help="the number of runs is divided by this in the safe mode")
+parser.add_argument("--modes", dest='modes', type=str, default="default,safe", help="comma separated list of 'default' and 'safe'")
+parser.add_argument("--report-format", dest='report_format', type=str, default="json", choices=["json", "bin"])
+parser.add_argument("--keep", dest='keep', type=str, default="", help="directory to keep the generated source, executables and reports in")
+args = parser.parse_args()
+
+template = """
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <iostream>
+#include <gcheck/gcheck.h>
+#include <gcheck/function_test.h>
+#include <gcheck/io_test.h>
+#include <gcheck/customtest.h>
+
+#ifndef SCALE_RUN_DIVISOR
+#define SCALE_RUN_DIVISOR 1
+#endif
+
+namespace {{
+
+int twice(int a) {{ return 2*a; }}
+
+void echo() {{
+    std::string line;
+    while(std::getline(std::cin, line))
+        std::cout << line << '\\n';
+}}
+
+class ScaleFunctionTest : public gcheck::FunctionTest<int, int> {{
+    void SetInputsAndOutputs() override {{
+        SetArguments((int)GetRunIndex());
+        SetReturn(2*(int)GetRunIndex());
+    }}
+public:
+    ScaleFunctionTest(const gcheck::TestInfo& info, int num_runs) : gcheck::FunctionTest<int, int>(info, num_runs, twice) {{}}
+}};
+
+const std::string io_data = [](){{
+    std::string line(79, 'x');
+    std::string data;
+    while(data.length() + line.length() + 1 <= {io_size})
+        data += line + '\\n';
+    return data;
+}}();
+
+class ScaleIOTest : public gcheck::IOTest<void> {{
+    void SetInputsAndOutputs() override {{
+        SetInput(io_data, true);
+        SetOutput(io_data);
+    }}
+public:
+    ScaleIOTest(const gcheck::TestInfo& info, int num_runs) : gcheck::IOTest<void>(info, num_runs, echo) {{}}
+}};
+
+class ScaleCustomTest : public gcheck::CustomTest {{
+    void TheTest() override {{ ExpectTrue(true, "custom"); }}
+public:
+    ScaleCustomTest(const gcheck::TestInfo& info) : gcheck::CustomTest(info) {{}}
+}};
+
+struct Entry {{
+    const char* suite;
+    const char* test;
+    char kind;
+    int num_runs;
+    const char* prerequisite;
+}};
+
+const Entry entries[] = {{
+{entries}
+}};
+
+std::vector<std::unique_ptr<gcheck::Test>> tests = [](){{
+    std::vector<std::unique_ptr<gcheck::Test>> tests;
+    for(auto& e : entries) {{
+        gcheck::TestInfo info(e.suite, e.test, e.prerequisite);
+        int num_runs = std::max(1, e.num_runs/SCALE_RUN_DIVISOR);
+        if(e.kind == 'f')
+            tests.emplace_back(new ScaleFunctionTest(info, num_runs));
+        else if(e.kind == 'i')
+            tests.emplace_back(new ScaleIOTest(info, num_runs));
+        else
+            tests.emplace_back(new ScaleCustomTest(info));
+    }}
+    return tests;
+}}();
+
+}} // anonymous
+"""
+
+def generate():
+    kinds = []
+    for t in range(args.tests):
+        if args.custom_every and t % args.custom_every == args.custom_every - 1:
+            kinds.append('c')
+        elif args.io_every and t % args.io_every == args.io_every - 1:
+            kinds.append('i')
+        else:
+            kinds.append('f')
+
+    n_function = kinds.count('f')*args.suites
+    fixed_runs = (kinds.count('i')*args.io_runs + kinds.count('c'))*args.suites
+    function_runs = max(1, (args.total_runs - fixed_runs)//max(1, n_function))
+
+    lines = []
+    total = 0
+    for s in range(args.suites):
+        for t, kind in enumerate(kinds):
+            runs = function_runs if kind == 'f' else args.io_runs if kind == 'i' else 1
+            prerequisite = "t{:05d}".format(t-1) if t % args.chain else ""
+            lines.append('    {{"s{:04d}", "t{:05d}", \'{}\', {}, "{}"}},'.format(s, t, kind, runs, prerequisite))
+            total += runs
+    return template.format(entries="\n".join(lines), io_size=args.io_size), total
+
+def build(dir, source, executable, defines):
+    cxx = [args.cxx, "-std=c++17", "-I" + os.path.join(root, "include")] + shlex.split(args.cxxflags) + defines
+    command = cxx + [source, "-L" + os.path.join(root, "lib"), "-lgcheck", "-o", executable]
+    result = subprocess.run(command, cwd=dir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if result.returncode != 0:
+        print(" ".join(command))
+        print(result.stdout)
+        sys.exit(1)
+
+def run(dir, executable, mode):
+    report = os.path.join(dir, "report_{}.{}".format(mode, args.report_format))
+    command = [os.path.join(dir, executable), "--no-confirm", "--report-format=" + args.report_format, report]
+    if mode == "safe":
+        command.insert(1, "--safe")
+
+    with open(os.devnull, "w") as null:
+        start = time.perf_counter()
+        process = subprocess.Popen(command, cwd=dir, stdin=subprocess.DEVNULL, stdout=null, stderr=null)
+        _, status, usage = os.wait4(process.pid, 0)
+        wall = time.perf_counter() - start
+    process.returncode = os.waitstatus_to_exitcode(status) if hasattr(os, "waitstatus_to_exitcode") else status
+    if process.returncode != 0:
+        print("{} exited with {}".format(" ".join(command), process.returncode))
+        sys.exit(1)
+
+    data = load_report(report)
+    runs = 0
+    function_time = 0
+    for suite in data["test_results"].values():
+        for test in suite.values():
+            summary = test.get("run_summary")
+            if summary:
+                runs += summary["runs"]
+                function_time += summary["total_run_time"]/1e9
+            else:
+                runs += 1
+
+    return {
+        "mode": mode,
+        "tests": args.suites*args.tests,
+        "runs": runs,
+        "wall_s": round(wall, 3),
+        "overhead_us_per_run": round((wall - function_time)/runs*1e6, 3),
+        "peak_rss_kb": usage.ru_maxrss,
+        "report_bytes": os.path.getsize(report),
+        "report_format": args.report_format,
+    }
+
+def main(dir):
+    source, total = generate()
+    with open(os.path.join(dir, "scale.cpp"), "w") as f:
+        f.write(source)
+    print("generated {} tests with {} runs".format(args.suites*args.tests, total), file=sys.stderr)
+
+    for mode in args.modes.split(","):
+        if mode not in ["default", "safe"]:
+            print("unknown mode " + mode)
+            sys.exit(1)
+        executable = "scale_" + mode
+        build(dir, "scale.cpp", executable, ["-DSCALE_RUN_DIVISOR={}".format(args.safe_divisor)] if mode == "safe" else [])
+        print(json.dumps(run(dir, executable, mode)))
+        sys.stdout.flush()
+
+if args.keep:
+    os.makedirs(args.keep, exist_ok=True)
+    main(os.path.abspath(args.keep))
+else:
+    with tempfile.TemporaryDirectory() as dir:
+        main(dir)
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+namespace gcheck {
+
+/*
+    Monotonic arena for the results of a single test.
+    arena_allocators made while an arena is set as arena_manager::manager take their memory from it.
+    Deallocating arena memory is a no-op, everything is released at once when the arena is.
+*/
+class arena_manager {
+public:
+    static arena_manager* manager;
+
+    arena_manager(size_t initial_size = 64*1024);
+    ~arena_manager();
+
+    void* allocate(size_t n, size_t alignment);
+    // Frees all the memory of the arena. Nothing allocated from it may be used afterwards
+    void Release();
+private:
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+/*
+    Sets 'arena' as arena_manager::manager for the lifetime of the scope and restores the previous one after it.
+*/
+class arena_scope {
+public:
+    arena_scope(arena_manager& arena) : previous_(arena_manager::manager) { arena_manager::manager = &arena; }
+    ~arena_scope() { arena_manager::manager = previous_; }
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+private:
+    arena_manager* previous_;
+};
+
+/*
+    Allocator for the per-test report data. Bound to the arena that was set when it was made, or to the heap
+    if none was, and copies keep the binding. Memory is thus always freed the way it was allocated, also after
+    the arena is gone, as long as it isn't used.
+*/
+template <class T>
+class arena_allocator {
+public:
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T value_type;
+    // Swapped containers keep their memory, assigned ones copy or move the elements to theirs
+    typedef std::true_type propagate_on_container_swap;
+
+    arena_allocator() : arena_(arena_manager::manager) {}
+    arena_allocator(const arena_allocator&) = default;
+
+    pointer allocate(size_type n, const void * = 0) {
+        if(arena_)
+            return (pointer)arena_->allocate(n*sizeof(T), alignof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(pointer p, size_type n) {
+        if(!arena_)
+            std::allocator<T>().deallocate(p, n);
+    }
+
+    arena_allocator& operator=(const arena_allocator&) = default;
+
+    template <class U>
+    struct rebind { typedef arena_allocator<U> other; };
+
+    template <class U>
+    arena_allocator(const arena_allocator<U>& other) : arena_(other.arena()) {}
+
+    // The arena the memory comes from, nullptr for the heap
+    arena_manager* arena() const { return arena_; }
+
+    template <class U>
+    bool operator==(const arena_allocator<U>& other) const { return arena_ == other.arena(); }
+    template <class U>
+    bool operator!=(const arena_allocator<U>& other) const { return arena_ != other.arena(); }
+private:
+    arena_manager* arena_;
+};
+
+} // gcheck
@@ -6,6 +6,14 @@
 #include <tuple>
 #include <variant>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <functional>
+#include <array>
+#include <atomic>
+
+#include "sfinae.h"
 
 namespace gcheck {
 /*
@@ -634,6 +642,215 @@ void advance(T& first, Args&... rest) {
     gcheck::advance(rest...);
 }
 
+/*
+    Operations made by a tested function on the Counting* types below. Counted only while the function
+    runs, so the copies and comparisons made by the harness itself are not included.
+    The counters are atomic, so the counts stay exact when the function uses the types from several threads.
+*/
+struct OperationCounts {
+    uint64_t comparisons = 0;
+    uint64_t dereferences = 0;
+    uint64_t copies = 0;
+    uint64_t moves = 0;
+    uint64_t allocations = 0;
+};
+
+class OperationCounter {
+public:
+    // Called around the tested function by FunctionTest
+    static void Start() {
+        for(auto& counter : counters_)
+            counter.store(0, std::memory_order_relaxed);
+        used_.store(false, std::memory_order_relaxed);
+        active_.store(true, std::memory_order_relaxed);
+    }
+    static void Stop() { active_.store(false, std::memory_order_relaxed); }
+
+    static OperationCounts Counts() {
+        OperationCounts counts;
+        counts.comparisons = counters_[Comparisons].load(std::memory_order_relaxed);
+        counts.dereferences = counters_[Dereferences].load(std::memory_order_relaxed);
+        counts.copies = counters_[Copies].load(std::memory_order_relaxed);
+        counts.moves = counters_[Moves].load(std::memory_order_relaxed);
+        counts.allocations = counters_[Allocations].load(std::memory_order_relaxed);
+        return counts;
+    }
+    // True if anything was counted since Start
+    static bool Used() { return used_.load(std::memory_order_relaxed); }
+
+    static void Comparison() { Count(Comparisons); }
+    static void Dereference() { Count(Dereferences); }
+    static void Copy() { Count(Copies); }
+    static void Move() { Count(Moves); }
+    static void Allocation() { Count(Allocations); }
+private:
+    enum Operation { Comparisons, Dereferences, Copies, Moves, Allocations, NumOperations };
+
+    static std::array<std::atomic<uint64_t>, NumOperations> counters_;
+    static std::atomic<bool> active_;
+    static std::atomic<bool> used_;
+
+    static void Count(Operation operation) {
+        if(active_.load(std::memory_order_relaxed)) {
+            counters_[operation].fetch_add(1, std::memory_order_relaxed);
+            used_.store(true, std::memory_order_relaxed);
+        }
+    }
+};
+
+// c*n*log2(n) rounded up, e.g. for SetMaxComparisons
+inline uint64_t NLogN(size_t n, double c = 1) {
+    return n < 2 ? 0 : (uint64_t)std::ceil(c*n*std::log2((double)n));
+}
+
+// A comparator that counts its calls, e.g. CountingComparator<int>() or CountingComparator<int, std::greater<int>>()
+template<typename T, typename Compare = std::less<T>>
+class CountingComparator {
+public:
+    CountingComparator(Compare compare = Compare()) : compare_(compare) {}
+
+    template<typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+        OperationCounter::Comparison();
+        return compare_(a, b);
+    }
+
+    // The arguments are compared after the call. Comparators without state or operator== are always equal
+    bool operator==(const CountingComparator& other) const {
+        if constexpr(has_equal<Compare>::value)
+            return compare_ == other.compare_;
+        else
+            return std::is_empty_v<Compare>;
+    }
+    bool operator!=(const CountingComparator& other) const { return !(*this == other); }
+private:
+    Compare compare_;
+};
+
+// An iterator that counts the dereferences of the wrapped iterator
+template<typename It>
+class CountingIterator {
+    typedef std::iterator_traits<It> traits;
+public:
+    typedef typename traits::iterator_category iterator_category;
+    typedef typename traits::value_type value_type;
+    typedef typename traits::difference_type difference_type;
+    typedef typename traits::pointer pointer;
+    typedef typename traits::reference reference;
+
+    CountingIterator() : it_() {}
+    CountingIterator(It it) : it_(it) {}
+
+    It Base() const { return it_; }
+
+    reference operator*() const { OperationCounter::Dereference(); return *it_; }
+    auto operator->() const { OperationCounter::Dereference(); return std::addressof(*it_); }
+    reference operator[](difference_type n) const { OperationCounter::Dereference(); return it_[n]; }
+
+    CountingIterator& operator++() { ++it_; return *this; }
+    CountingIterator operator++(int) { return CountingIterator(it_++); }
+    CountingIterator& operator--() { --it_; return *this; }
+    CountingIterator operator--(int) { return CountingIterator(it_--); }
+    CountingIterator& operator+=(difference_type n) { it_ += n; return *this; }
+    CountingIterator& operator-=(difference_type n) { it_ -= n; return *this; }
+    CountingIterator operator+(difference_type n) const { return CountingIterator(it_ + n); }
+    CountingIterator operator-(difference_type n) const { return CountingIterator(it_ - n); }
+    friend CountingIterator operator+(difference_type n, const CountingIterator& it) { return it + n; }
+    difference_type operator-(const CountingIterator& other) const { return it_ - other.it_; }
+
+    bool operator==(const CountingIterator& other) const { return it_ == other.it_; }
+    bool operator!=(const CountingIterator& other) const { return it_ != other.it_; }
+    bool operator<(const CountingIterator& other) const { return it_ < other.it_; }
+    bool operator>(const CountingIterator& other) const { return it_ > other.it_; }
+    bool operator<=(const CountingIterator& other) const { return it_ <= other.it_; }
+    bool operator>=(const CountingIterator& other) const { return it_ >= other.it_; }
+private:
+    It it_;
+};
+
+// A value that counts its copies, moves and comparisons, the elements of CountingContainer
+template<typename T>
+class Counted {
+public:
+    Counted() : value_() {}
+    Counted(const T& value) : value_(value) {}
+    Counted(const Counted& other) : value_(other.value_) { OperationCounter::Copy(); }
+    Counted(Counted&& other) noexcept(std::is_nothrow_move_constructible_v<T>) : value_(std::move(other.value_)) { OperationCounter::Move(); }
+
+    Counted& operator=(const Counted& other) {
+        value_ = other.value_;
+        OperationCounter::Copy();
+        return *this;
+    }
+    Counted& operator=(Counted&& other) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        value_ = std::move(other.value_);
+        OperationCounter::Move();
+        return *this;
+    }
+
+    const T& Value() const { return value_; }
+    operator const T&() const { return value_; }
+
+private:
+    T value_;
+};
+
+// Comparisons with both Counted and plain values, the plain ones would be ambiguous with the conversion to T
+#define GCHECK_COUNTED_COMPARISON(op) \
+    template<typename T> \
+    bool operator op(const Counted<T>& a, const Counted<T>& b) { OperationCounter::Comparison(); return a.Value() op b.Value(); } \
+    template<typename T> \
+    bool operator op(const Counted<T>& a, const T& b) { OperationCounter::Comparison(); return a.Value() op b; } \
+    template<typename T> \
+    bool operator op(const T& a, const Counted<T>& b) { OperationCounter::Comparison(); return a op b.Value(); }
+GCHECK_COUNTED_COMPARISON(==)
+GCHECK_COUNTED_COMPARISON(!=)
+GCHECK_COUNTED_COMPARISON(<)
+GCHECK_COUNTED_COMPARISON(>)
+GCHECK_COUNTED_COMPARISON(<=)
+GCHECK_COUNTED_COMPARISON(>=)
+#undef GCHECK_COUNTED_COMPARISON
+
+// An allocator that counts the allocations
+template<typename T>
+class CountingAllocator {
+public:
+    typedef T value_type;
+
+    CountingAllocator() noexcept {}
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        OperationCounter::Allocation();
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* ptr, size_t n) { std::allocator<T>().deallocate(ptr, n); }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+template<typename C>
+struct counting_container;
+template<template<typename, typename> class C, typename T, typename A>
+struct counting_container<C<T, A>> {
+    typedef C<Counted<T>, CountingAllocator<Counted<T>>> type;
+};
+template<template<typename, typename, typename> class C, typename T, typename Compare, typename A>
+struct counting_container<C<T, Compare, A>> {
+    typedef C<Counted<T>, CountingComparator<Counted<T>, Compare>, CountingAllocator<Counted<T>>> type;
+};
+
+/*
+    The container C with Counted elements and CountingAllocator, e.g. CountingContainer<std::vector<int>> is
+    std::vector<Counted<int>, CountingAllocator<Counted<int>>>. Works for the standard sequence containers and sets.
+*/
+template<typename C>
+using CountingContainer = typename counting_container<C>::type;
+
 // TODO: these were causing trouble for some reason
 // Theoretically improves compile times with precompiled gcheck TODO: benchmark
 /*extern template class SequenceArgument<int>;
@@ -0,0 +1,158 @@
+/*
+    Compact binary encoding of test results.
+    All values are little-endian, also on big-endian hosts, and strings are stored raw as a 32 bit length followed by the bytes.
+    While InternTable::table is set, UserObjects are written as 32 bit ids of its entries.
+    BinaryReader reads back the inline layout, tools/report_parser.py reads both.
+    Bump 'version' whenever the layout changes.
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <algorithm>
+
+namespace gcheck {
+
+template<template<typename> class allocator>
+class _TestReport;
+
+template<template<typename> class allocator>
+struct _CaseEntry;
+
+template<template<typename> class allocator>
+struct _FunctionEntry;
+
+template<template<typename> class allocator>
+struct _RunRow;
+
+template<template<typename> class allocator>
+struct _TestData;
+
+struct RunSummary;
+
+template<template<typename> class allocator>
+class _UserObject;
+
+class Prerequisite;
+
+// Converts between host and little-endian byte order, the conversion is its own inverse
+template<typename T>
+T LittleEndian(T value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&value, bytes, sizeof(T));
+#endif
+    return value;
+}
+
+class BinaryWriter {
+public:
+    static const char magic[8];
+    static const uint32_t version;
+
+    enum Flags : uint32_t {
+        Interned = 1, // UserObjects are indices to a table stored after the header
+        Profiled = 2 // the harness profile follows the tests
+    };
+
+    BinaryWriter& WriteU8(uint8_t value) { return WriteValue(value); }
+    BinaryWriter& WriteU16(uint16_t value) { return WriteValue(value); }
+    BinaryWriter& WriteU32(uint32_t value) { return WriteValue(value); }
+    BinaryWriter& WriteI32(int32_t value) { return WriteValue(value); }
+    BinaryWriter& WriteI64(int64_t value) { return WriteValue(value); }
+    BinaryWriter& WriteF64(double value) { return WriteValue(value); }
+    BinaryWriter& WriteBool(bool value) { return WriteU8(value ? 1 : 0); }
+    BinaryWriter& WriteString(std::string_view str);
+    BinaryWriter& WriteRaw(const void* data, size_t size);
+    // Writes the file header: magic bytes, format version and flags
+    BinaryWriter& WriteHeader(uint32_t flags = 0);
+
+    // Report types, instantiated for std::allocator and arena_allocator in binary.cpp
+    template<template<typename> class A>
+    BinaryWriter& Write(const _UserObject<A>& o);
+    template<template<typename> class A>
+    BinaryWriter& Write(const _CaseEntry<A>& e);
+    template<template<typename> class A>
+    BinaryWriter& Write(const _FunctionEntry<A>& e);
+    template<template<typename> class A>
+    BinaryWriter& Write(const _RunRow<A>& e);
+    template<template<typename> class A>
+    BinaryWriter& Write(const _TestReport<A>& r);
+    template<template<typename> class A>
+    BinaryWriter& Write(const _TestData<A>& data);
+    BinaryWriter& Write(const RunSummary& runs);
+    BinaryWriter& Write(const Prerequisite& pre);
+
+    const std::string& str() const { return buffer_; }
+    void Clear() { buffer_.clear(); }
+private:
+    std::string buffer_;
+
+    template<typename T>
+    BinaryWriter& WriteValue(T value) {
+        value = LittleEndian(value);
+        return WriteRaw(&value, sizeof(T));
+    }
+
+    template<template<typename> class A>
+    static std::string Encode(const _UserObject<A>& o);
+    // A run from a _FunctionEntry or a _RunRow, both are written alike
+    template<typename E>
+    BinaryWriter& WriteRun(const E& e);
+};
+
+/*
+    Reads records written by BinaryWriter without interning.
+    Throws std::runtime_error if the data ends before the record does.
+*/
+class BinaryReader {
+public:
+    BinaryReader(const void* data, size_t size) : data_((const char*)data), size_(size) {}
+
+    uint8_t ReadU8() { return ReadValue<uint8_t>(); }
+    uint16_t ReadU16() { return ReadValue<uint16_t>(); }
+    uint32_t ReadU32() { return ReadValue<uint32_t>(); }
+    int32_t ReadI32() { return ReadValue<int32_t>(); }
+    int64_t ReadI64() { return ReadValue<int64_t>(); }
+    double ReadF64() { return ReadValue<double>(); }
+    bool ReadBool() { return ReadU8() != 0; }
+    std::string_view ReadString();
+    const char* ReadRaw(size_t size);
+
+    // Report types, instantiated for std::allocator and arena_allocator in binary.cpp
+    template<template<typename> class A>
+    BinaryReader& Read(_UserObject<A>& o);
+    template<template<typename> class A>
+    BinaryReader& Read(_CaseEntry<A>& e);
+    template<template<typename> class A>
+    BinaryReader& Read(_FunctionEntry<A>& e);
+    template<template<typename> class A>
+    BinaryReader& Read(_TestReport<A>& r);
+    // Reads everything but the prerequisite, which stays as it is
+    template<template<typename> class A>
+    BinaryReader& Read(_TestData<A>& data);
+
+    size_t Remaining() const { return size_ - pos_; }
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+
+    template<typename T>
+    T ReadValue() {
+        T value;
+        std::memcpy(&value, ReadRaw(sizeof(T)), sizeof(T));
+        return LittleEndian(value);
+    }
+};
+
+// FNV-1a hash for detecting torn or corrupted records
+uint64_t Checksum(const void* data, size_t size);
+
+} // gcheck
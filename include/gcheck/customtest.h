@@ -81,7 +81,7 @@ void CustomTest::CompareWithCallable(int num, const F& correct, const S& under_t
         gcheck::advance(args...);
 
         it->arguments = UserObject(std::tuple(extract_argument(args)...));
-        auto correct_res = Result(correct(args...));
+        auto correct_res = Result(Reference([&]() { return correct(args...); }, it->arguments->string()));
         auto correct_ans = correct_res.output;
         it->output_expected = UserObject(correct_ans);
 
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+
+namespace gcheck {
+
+/*
+    A submission compiled as a shared object and loaded with dlopen. Only available on linux.
+    While Submission::current is set, Dynamic functions call into it.
+*/
+class Submission {
+public:
+    static Submission* current;
+
+    // Throws std::runtime_error if the object can't be loaded
+    Submission(const std::string& path);
+    ~Submission();
+
+    Submission(const Submission&) = delete;
+    Submission& operator=(const Submission&) = delete;
+
+    // Returns the address of 'name' or nullptr if the object doesn't define it
+    void* Symbol(const std::string& name) const;
+    // Returns the names used by Dynamic functions that the object doesn't define
+    std::vector<std::string> Missing() const;
+
+    const std::string& Path() const { return path_; }
+
+    // Names of all the Dynamic functions, checked by Missing
+    static std::vector<std::string>& Names() {
+        static std::vector<std::string> names;
+        return names;
+    }
+private:
+    std::string path_;
+    void* handle_ = nullptr;
+};
+
+template<typename Signature>
+class Dynamic;
+
+/*
+    Function that is looked up by name from the current submission when called, e.g.
+    gcheck::Dynamic<int(int)> twice("twice"); FUNCTIONTEST(suite, test, 10, twice) { ... }
+    C++ functions have to be declared extern "C" in the submission or given by their mangled name.
+*/
+template<typename ReturnT, typename... Args>
+class Dynamic<ReturnT(Args...)> : public std::function<ReturnT(Args...)> {
+public:
+    Dynamic(const std::string& name) : std::function<ReturnT(Args...)>(
+            [name, loaded = (const Submission*)nullptr, function = (ReturnT(*)(Args...))nullptr](Args... args) mutable -> ReturnT {
+                if(loaded != Submission::current) { // looked up once per submission
+                    if(!Submission::current)
+                        throw std::runtime_error("No submission loaded for " + name);
+                    function = (ReturnT(*)(Args...))Submission::current->Symbol(name);
+                    loaded = Submission::current;
+                }
+                if(!function)
+                    throw std::runtime_error("Submission doesn't define " + name);
+                return function(std::forward<Args>(args)...);
+            }) {
+        Submission::Names().push_back(name);
+    }
+};
+
+} // gcheck
@@ -4,12 +4,17 @@
 #include <functional>
 #include <chrono>
 #include <stdexcept>
+#include <optional>
+#include <algorithm>
+#include <vector>
 
 #include "macrotools.h"
 #include "gcheck.h"
 #include "sfinae.h"
 #include "user_object.h"
 #include "multiprocessing.h"
+#include "machine.h"
+#include "timer.h"
 
 namespace gcheck {
 
@@ -104,6 +109,15 @@ namespace {
     template<typename T>
     using ConditionalT_t = typename ConditionalT<T>::type;
 
+    // Does nothing with the signature of a tested function, for measuring what calling one costs
+    template<typename ReturnT, typename... Args>
+    ReturnT EmptyFunction(Args...) {
+        if constexpr(!std::is_void_v<ReturnT>) {
+            static std::remove_cv_t<std::remove_reference_t<ReturnT>> value{};
+            return value;
+        }
+    }
+
 } // anonymous
 
 /* Creates a function for creating an object on the stack
@@ -143,23 +157,22 @@ auto ClassPtrGenerator(NextType<Args2...>& args) {
 }
 
 /*
-    Base class for testing functions.
+    The type independent part of FunctionTest: the run loop, hooks, timing and forking.
+    Compiled once in the library, FunctionTest only adds the typed arguments and the call.
 */
-template<typename ReturnT, typename... Args>
-class FunctionTest : public Test {
+class FunctionTestBase : public Test {
 public:
-    typedef MakeDelta_t<ConditionalT_t<ReturnT>> ReturnType;
-    typedef TupleWrapper<std::remove_cv_t<std::remove_reference_t<Args>>...> TupleWrapperType;
-    typedef typename TupleWrapperType::storage_tuple_type StorageTupleType;
-    typedef typename TupleWrapperType::tuple_type TupleType;
-    typedef void(*CompareFunc)(void);
-
-    FunctionTest(const TestInfo& info, int num_runs, const std::function<ReturnT(Args...)>& func) : Test(info), num_runs_(num_runs), function_(func) { }
+    FunctionTestBase(const TestInfo& info, int num_runs) : Test(info), num_runs_(num_runs) { }
 
     template<typename F>
     void AddResetTest(F&& func) {
         reset_vars_functions_.push_back(std::forward<F>(func));
     }
+    /*
+        Adds functions called right before and after each run with the run index and its entry.
+        With --safe or SetParallelRuns the run, and so these functions, run in a forked process. Only the entry
+        is read back from it, anything else they change is lost after the run.
+    */
     template<typename F>
     void AddPreRun(F&& func) {
         pre_run_functions_.push_back(std::forward<F>(func));
@@ -168,23 +181,165 @@ public:
     void AddPostRun(F&& func) {
         post_run_functions_.push_back(std::forward<F>(func));
     }
+    // Adds a function that is called in each worker process of parallel runs before the run
+    template<typename F>
+    void AddChildInit(F&& func) {
+        child_init_functions_.push_back(std::forward<F>(func));
+    }
+    // Adds functions called around the untimed call of SetCacheMode(Warm), to undo what it changed
+    template<typename F>
+    void AddPreWarmUp(F&& func) {
+        pre_warm_up_functions_.push_back(std::forward<F>(func));
+    }
+    template<typename F>
+    void AddPostWarmUp(F&& func) {
+        post_warm_up_functions_.push_back(std::forward<F>(func));
+    }
 protected:
-    CompareFunc comp_function_ = nullptr;
-
-    std::optional<StorageTupleType> args_;
-    std::optional<StorageTupleType> args_after_;
-    std::optional<ReturnType> expected_return_value_;
     std::optional<std::chrono::nanoseconds> max_run_time_;
+    std::optional<uint64_t> max_read_calls_;
+    std::optional<uint64_t> max_write_calls_;
+    bool count_io_ = false;
+    std::optional<uint64_t> max_comparisons_;
+    std::optional<uint64_t> max_allocations_;
+    bool count_operations_ = false;
+    uint32_t batch_ = 1;
+    CacheMode cache_mode_ = UnchangedCache;
+    size_t eviction_bytes_ = 0;
+    std::chrono::nanoseconds call_overhead_ = std::chrono::nanoseconds(0); // cost of the dispatch to the tested function
     std::chrono::duration<double> timeout_ = std::chrono::duration<double>::zero();
+    double relative_multiplier_ = 0; // set with SetRelativeTimeout
+    std::chrono::duration<double> min_relative_timeout_ = std::chrono::duration<double>::zero();
 
-    std::optional<StorageTupleType> last_args_;
     int num_runs_;
     size_t run_index_ = 0;
+    size_t parallel_runs_ = 1;
     bool check_arguments_ = true;
 
     std::vector<std::function<void()>> reset_vars_functions_;
     std::vector<std::function<void(size_t, FunctionEntry&)>> pre_run_functions_;
     std::vector<std::function<void(size_t, FunctionEntry&)>> post_run_functions_;
+    std::vector<std::function<void()>> child_init_functions_;
+    std::vector<std::function<void()>> pre_warm_up_functions_;
+    std::vector<std::function<void()>> post_warm_up_functions_;
+
+    void IgnoreArgumentsAfter() { check_arguments_ = false; }
+    void SetMaxRunTime(std::chrono::nanoseconds ns) { max_run_time_ = ns; }
+    void SetMaxRunTime(unsigned long long ns) { max_run_time_ = std::chrono::nanoseconds(ns); }
+    /*
+        Calls the tested function 'calls' times in one timed window and reports the run time per call, for
+        functions faster than the resolution of the timing. Each call gets its own copy of the arguments,
+        made before the timing, and the arguments after and the return value are those of the last call.
+    */
+    void SetBatch(uint32_t calls) { batch_ = std::max<uint32_t>(calls, 1); }
+    /*
+        Cold evicts the caches after the arguments have been copied for the call, by streaming through
+        'eviction_bytes' (by default one and a half times the largest cache), so the call and its arguments
+        start from memory. Warm calls the function once untimed with a copy of the same arguments first.
+        Its output, exceptions and changes to the input and to the object of METHODTEST (if it can be copied)
+        are undone, other side effects aren't. With SetBatch only the first call is cold.
+    */
+    void SetCacheMode(CacheMode mode, size_t eviction_bytes = 0) { cache_mode_ = mode; eviction_bytes_ = eviction_bytes; }
+    /*
+        Fails the runs whose thread makes more than 'n' read or write system calls, on any file descriptor
+        and not only on the standard streams, including flushing the standard output and error after the
+        call. Only available on linux.
+    */
+    void SetMaxReadSyscalls(uint64_t n) { max_read_calls_ = n; count_io_ = true; }
+    void SetMaxWriteSyscalls(uint64_t n) { max_write_calls_ = n; count_io_ = true; }
+    // Counts the system calls into the report without a limit
+    void CountIO(bool count = true) { count_io_ = count; }
+    /*
+        Fails the runs in which the tested function makes more than 'n' comparisons or allocations with the
+        Counting* argument types of argument.h, e.g. SetMaxComparisons(NLogN(size, 2)). The counts are
+        reported for the runs that use the types even without a limit, CountOperations reports them always.
+    */
+    void SetMaxComparisons(uint64_t n) { max_comparisons_ = n; count_operations_ = true; }
+    void SetMaxAllocations(uint64_t n) { max_allocations_ = n; count_operations_ = true; }
+    void CountOperations(bool count = true) { count_operations_ = count; }
+    void SetTimeout(std::chrono::duration<double> seconds) { timeout_ = seconds; }
+    void SetTimeout(double seconds) { timeout_ = std::chrono::duration<double>(seconds); }
+    /*
+        Runs up to 'n' runs at the same time in forked worker processes. The inputs are still set in order in
+        this process and the results are kept in run order. Each run sees the state as it was when its inputs
+        were set, so tests relying on state carried from one run to the next should keep the default of 1.
+    */
+    void SetParallelRuns(size_t n) { parallel_runs_ = std::max<size_t>(n, 1); }
+
+    size_t GetRunIndex() { return run_index_; }
+
+    virtual void SetInputsAndOutputs() = 0;
+
+    void RunOnce(FunctionEntry& data);
+    virtual void ResetTestVars();
+
+    // Makes the arguments of the current run the ones returned by GetLastArguments
+    virtual void KeepLastArguments() = 0;
+    // Calls the tested function with the arguments of the current run and fills in 'data'
+    virtual void CallFunction(FunctionEntry& data) = 0;
+    // Measures call_overhead_
+    virtual void CalibrateCall() = 0;
+    // Run time of the reference of SetRelativeTimeout with the arguments of the current run
+    virtual std::optional<std::chrono::nanoseconds> ReferenceTime() { return std::nullopt; }
+    // Called by CallFunction right before and after the tested function, measures the run time, I/O and operations into 'data'
+    void StartCall();
+    void FinishCall(FunctionEntry& data);
+    /*
+        Called right before StartCall, 'warm_up' calls the tested function like the timed call. An exception
+        from the warm-up is left for the timed call to throw, and what it wrote to the standard output and error
+        is discarded. Its operations aren't counted, as the counting only starts with StartCall. 'tested' is
+        false for the reference of SetRelativeTimeout, which the warm-up hooks of the tested call don't apply to
+    */
+    template<typename F>
+    void PrepareCache(F&& warm_up, bool tested = true) {
+        if(cache_mode_ == Warm) {
+            if(tested)
+                for(auto& f : pre_warm_up_functions_)
+                    f();
+            try {
+                warm_up();
+            } catch(...) {}
+            FinishWarmUp(tested);
+        } else if(cache_mode_ == Cold) {
+            Machine::EvictCaches(eviction_bytes_);
+        }
+    }
+private:
+    std::chrono::nanoseconds call_start_;
+    int io_fd_ = -1; // /proc/thread-self/io while counting a call
+    IOCounts io_start_;
+    Machine::Snapshot conditions_start_; // while recording the timing conditions of a call
+    // Limits of the current run, scaled or derived from the reference
+    std::chrono::duration<double> run_timeout_ = std::chrono::duration<double>::zero();
+    std::optional<std::chrono::nanoseconds> run_max_run_time_;
+
+    // Flushes the output of the warm-up call, so that it isn't counted as written by the timed one, and calls post_warm_up_functions_ if 'tested'
+    void FinishWarmUp(bool tested);
+    void SetRunLimits();
+    void ActualTest() override;
+};
+
+/*
+    Base class for testing functions.
+*/
+template<typename ReturnT, typename... Args>
+class FunctionTest : public FunctionTestBase {
+public:
+    typedef MakeDelta_t<ConditionalT_t<ReturnT>> ReturnType;
+    typedef TupleWrapper<std::remove_cv_t<std::remove_reference_t<Args>>...> TupleWrapperType;
+    typedef typename TupleWrapperType::storage_tuple_type StorageTupleType;
+    typedef typename TupleWrapperType::tuple_type TupleType;
+    typedef void(*CompareFunc)(void);
+
+    FunctionTest(const TestInfo& info, int num_runs, const std::function<ReturnT(Args...)>& func) : FunctionTestBase(info, num_runs), function_(func) { }
+protected:
+    CompareFunc comp_function_ = nullptr;
+
+    std::optional<StorageTupleType> args_;
+    std::optional<StorageTupleType> args_after_;
+    std::optional<ReturnType> expected_return_value_;
+
+    std::optional<StorageTupleType> last_args_;
 
     // Sets the input arguments given to the tested function
     template<typename... Args2>
@@ -203,41 +358,117 @@ protected:
     void SetArgumentsAfter(const TupleType& args) {
         std::apply([this](auto... x){this->SetArgumentsAfter(x...);}, args);
     }
-    void IgnoreArgumentsAfter() { check_arguments_ = false; }
     // Sets the expected output (stdout) of tested function
     void SetReturn(const ReturnType& val) { expected_return_value_ = val; }
-    void SetMaxRunTime(std::chrono::nanoseconds ns) { max_run_time_ = ns; }
-    void SetMaxRunTime(unsigned long long ns) { max_run_time_ = std::chrono::nanoseconds(ns); }
-    void SetTimeout(std::chrono::duration<double> seconds) { timeout_ = seconds; }
-    void SetTimeout(double seconds) { timeout_ = std::chrono::duration<double>(seconds); }
+    /*
+        Sets the max run time of the run to 'multiplier' times the run time of 'model' called with the same
+        arguments, and the timeout to the same but at least 'min_timeout', which also covers forking. The model
+        is timed in the test process like the tested function, with the same cache mode and batch, and the best
+        of reference_repeats is kept by arguments for the following runs of the test. Replaces SetTimeout and
+        SetMaxRunTime and isn't scaled by the host speed, which the reference already reflects.
+    */
+    template<typename F>
+    void SetRelativeTimeout(F&& model, double multiplier, std::chrono::duration<double> min_timeout = std::chrono::milliseconds(500)) {
+        relative_model_ = std::forward<F>(model);
+        relative_multiplier_ = multiplier;
+        min_relative_timeout_ = min_timeout;
+    }
 
     const std::optional<TupleType>& GetLastArguments() const { return last_args_; }
-    size_t GetRunIndex() { return run_index_; }
-
-    virtual void SetInputsAndOutputs() = 0;
 
-    void RunOnce(FunctionEntry& data);
-    virtual void ResetTestVars();
+    void ResetTestVars() override;
+    void KeepLastArguments() override { last_args_ = args_; }
+    void CallFunction(FunctionEntry& data) override;
+    void CalibrateCall() override {
+        if constexpr(calibrates_signature)
+            CalibrateCall(EmptyFunction<ReturnT, Args...>);
+        else
+            CalibrateCall(nullptr);
+    }
+    // The return and argument types can be made up for calling an empty function with the tested signature
+    static constexpr bool calibrates_signature = std::is_default_constructible_v<TupleType>
+        && (std::is_void_v<ReturnT> || std::is_default_constructible_v<std::remove_cv_t<std::remove_reference_t<ReturnT>>>);
+    /*
+        Sets call_overhead_ to the cost of calling 'empty', an empty function wrapped the way function_ wraps
+        the tested one, with default constructed arguments applied from a tuple like the timed call. Without
+        'empty' only the cost of calling through std::function is measured. Read through a volatile pointer,
+        so the compiler can't see what it calls any more than it sees function_
+    */
+    void CalibrateCall(std::function<ReturnT(Args...)> empty) {
+        if constexpr(calibrates_signature) {
+            if(empty) {
+                TupleType args{};
+                std::function<ReturnT(Args...)>* volatile function = &empty;
+                call_overhead_ = Timer::MeasureCall([&function, &args]() { std::apply(*function, args); });
+                return;
+            }
+        }
+        std::function<void()> nothing = []() {};
+        std::function<void()>* volatile function = &nothing;
+        call_overhead_ = Timer::MeasureCall([&function]() { (*function)(); });
+    }
+    std::optional<std::chrono::nanoseconds> ReferenceTime() override;
 private:
-    virtual void ActualTest();
-
     std::function<ReturnT(Args...)> function_;
+    std::function<ReturnT(Args...)> relative_model_;
+    static constexpr int reference_repeats = 3;
+    // Run times of relative_model_ by arguments, searched in order as the arguments are only comparable
+    std::vector<std::pair<std::optional<StorageTupleType>, std::chrono::nanoseconds>> reference_times_;
 };
 
 template<typename ReturnT, typename... Args>
 void FunctionTest<ReturnT, Args...>::ResetTestVars() {
+    FunctionTestBase::ResetTestVars();
     args_.reset();
     args_after_.reset();
     expected_return_value_.reset();
-    check_arguments_ = true;
 }
 
 template<typename ReturnT, typename... Args>
-void FunctionTest<ReturnT, Args...>::RunOnce(FunctionEntry& data) {
-    for(auto& f : pre_run_functions_)
-        f(run_index_, data);
+std::optional<std::chrono::nanoseconds> FunctionTest<ReturnT, Args...>::ReferenceTime() {
+    if(!relative_model_)
+        return std::nullopt;
+    for(auto& [args, time] : reference_times_)
+        if(args == args_)
+            return time;
+
+    if constexpr(sizeof...(Args) != 0) {
+        if(!args_)
+            return std::nullopt;
+    }
+
+    // Timed the way CallFunction times the tested function
+    auto time = std::chrono::nanoseconds::max();
+    for(int repeat = 0; repeat < reference_repeats; repeat++) {
+        std::chrono::nanoseconds start, elapsed;
+        if constexpr(sizeof...(Args) != 0) {
+            auto args = (TupleType)*args_;
+            PrepareCache([this, &args]() {
+                auto copy = args;
+                std::apply(relative_model_, copy);
+            }, false);
+            std::vector<TupleType> batch(batch_ - 1, args);
+            start = Timer::Now();
+            for(auto& copy : batch)
+                std::apply(relative_model_, copy);
+            std::apply(relative_model_, args);
+            elapsed = Timer::Now() - start;
+        } else {
+            PrepareCache([this]() { relative_model_(); }, false);
+            start = Timer::Now();
+            for(uint32_t i = 0; i < batch_; i++)
+                relative_model_();
+            elapsed = Timer::Now() - start;
+        }
+        time = std::min(time, Timer::Correct(elapsed, batch_, call_overhead_));
+    }
+    reference_times_.emplace_back(args_, time);
+    return time;
+}
 
-    last_args_ = args_;
+template<typename ReturnT, typename... Args>
+void FunctionTest<ReturnT, Args...>::CallFunction(FunctionEntry& data) {
+    KeepLastArguments();
 
     if(check_arguments_) {
         if(!args_after_ && args_)
@@ -251,16 +482,26 @@ void FunctionTest<ReturnT, Args...>::RunOnce(FunctionEntry& data) {
             auto args = (FunctionTest::TupleType)*args_;
             data.arguments = args;
 
+            PrepareCache([this, &args]() {
+                auto copy = args;
+                std::apply(function_, copy);
+            });
+            // The calls before the last get copies, so that each sees the arguments unchanged
+            std::vector<TupleType> batch(batch_ - 1, args);
             if constexpr(std::is_same<ReturnT, void>::value) {
-                auto t1 = std::chrono::high_resolution_clock::now();
+                StartCall();
+                for(auto& copy : batch)
+                    std::apply(function_, copy);
                 std::apply(function_, args);
-                data.run_time = std::chrono::high_resolution_clock::now() - t1;
+                FinishCall(data);
 
                 data.result = true;
             } else {
-                auto t1 = std::chrono::high_resolution_clock::now();
+                StartCall();
+                for(auto& copy : batch)
+                    std::apply(function_, copy);
                 auto ret = std::apply(function_, args);
-                data.run_time = std::chrono::high_resolution_clock::now() - t1;
+                FinishCall(data);
 
                 data.return_value = ret;
                 if(expected_return_value_)
@@ -274,60 +515,26 @@ void FunctionTest<ReturnT, Args...>::RunOnce(FunctionEntry& data) {
             data.result = false;
         }
     } else if constexpr(std::is_same<ReturnT, void>::value) {
-        auto t1 = std::chrono::high_resolution_clock::now();
-        function_();
-        data.run_time = std::chrono::high_resolution_clock::now() - t1;
+        PrepareCache([this]() { function_(); });
+        StartCall();
+        for(uint32_t i = 0; i < batch_; i++)
+            function_();
+        FinishCall(data);
 
         data.result = !args_after_ && !args_;
     } else {
-        auto t1 = std::chrono::high_resolution_clock::now();
+        PrepareCache([this]() { function_(); });
+        StartCall();
+        for(uint32_t i = 1; i < batch_; i++)
+            function_();
         auto ret = function_();
-        data.run_time = std::chrono::high_resolution_clock::now() - t1;
+        FinishCall(data);
 
         data.return_value = ret;
         if(expected_return_value_)
             data.return_value_expected = *expected_return_value_;
         data.result = (!expected_return_value_ || *expected_return_value_ == ret) && (!args_after_ && !args_);
     }
-
-    data.max_run_time = max_run_time_;
-    if(max_run_time_)
-        data.result = data.result && data.run_time <= max_run_time_.value();
-
-    for(auto& f : post_run_functions_)
-        f(run_index_, data);
-}
-
-template<typename ReturnT, typename... Args>
-void FunctionTest<ReturnT, Args...>::ActualTest() {
-    TestReport report = TestReport::Make<FunctionData>();
-    auto& data = report.Get<FunctionData>();
-
-    data.resize(num_runs_);
-
-    run_index_ = 0;
-    for(auto it = data.begin(); it != data.end(); it++, run_index_++) {
-        ResetTestVars();
-
-        for(auto& f : reset_vars_functions_)
-            f();
-
-        SetInputsAndOutputs();
-
-        if(do_safe_run_) {
-#if defined(__linux__)
-            it->status = gcheck::RunForked(timeout_, *it, 1024*1024, std::bind(&FunctionTest::RunOnce, this, std::placeholders::_1), *it);
-            it->result = it->result && it->status == OK;
-#else
-            throw std::runtime_error("Safe running is only supported on linux.");
-#endif
-        } else {
-            RunOnce(*it);
-        }
-        it->timeout = timeout_;
-    }
-    AddReport(report);
-    data_.status = Finished;
 }
 
 } // gcheck
@@ -338,6 +545,7 @@ void FunctionTest<ReturnT, Args...>::ActualTest() {
     template<typename ReturnT, typename... Args> \
     class GCHECK_TEST_##suitename##_##testname : public gcheck::FunctionTest<ReturnT, Args...> { \
         using gcheck::FunctionTest<ReturnT, Args...>::SetTimeout; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetRelativeTimeout; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArgumentsAfter; \
         using gcheck::FunctionTest<ReturnT, Args...>::IgnoreArgumentsAfter; \
@@ -345,8 +553,19 @@ void FunctionTest<ReturnT, Args...>::ActualTest() {
         using gcheck::FunctionTest<ReturnT, Args...>::GetLastArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::GetRunIndex; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(std::function<ReturnT(Args...)> func) : gcheck::FunctionTest<ReturnT, Args...>(gcheck::TestInfo(#suitename, #testname, __TAIL(__VA_ARGS__)), num_runs, func) { } \
@@ -360,6 +579,7 @@ void FunctionTest<ReturnT, Args...>::ActualTest() {
     template<typename ReturnT, typename... Args> \
     class GCHECK_TEST_##suitename##_##testname : public gcheck::FunctionTest<ReturnT, Args...> { \
         using gcheck::FunctionTest<ReturnT, Args...>::SetTimeout; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetRelativeTimeout; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArgumentsAfter; \
         using gcheck::FunctionTest<ReturnT, Args...>::IgnoreArgumentsAfter; \
@@ -367,8 +587,19 @@ void FunctionTest<ReturnT, Args...>::ActualTest() {
         using gcheck::FunctionTest<ReturnT, Args...>::GetLastArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::GetRunIndex; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(std::function<ReturnT(Args...)> func) : gcheck::FunctionTest<ReturnT, Args...>(gcheck::TestInfo(#suitename, #testname), num_runs, func) { } \
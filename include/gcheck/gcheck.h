@@ -2,12 +2,19 @@
 
 #include <cmath>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <unordered_map>
 #include <variant>
 #include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <iterator>
 
 #include "argument.h"
 #include "json.h"
@@ -15,6 +22,9 @@
 #include "sfinae.h"
 #include "macrotools.h"
 #include "multiprocessing.h"
+#include "arena_allocator.h"
+#include "reference_cache.h"
+#include "dynamic.h"
 
 namespace gcheck {
 
@@ -144,6 +154,56 @@ template<template<typename> class allocator = std::allocator>
 using _CaseData = std::vector<_CaseEntry<allocator>, allocator<_CaseEntry<allocator>>>;
 using CaseData = _CaseData<>;
 
+/*
+    Read and write system calls made by the thread running a tested function and the bytes they moved.
+    Taken from /proc/thread-self/io, so every file descriptor is counted, not only the standard streams.
+*/
+struct IOCounts {
+    uint64_t read_calls = 0;
+    uint64_t write_calls = 0;
+    uint64_t read_bytes = 0;
+    uint64_t written_bytes = 0;
+};
+
+/*
+    State of the machine around a timed run, so that a run slowed down by other load can be told apart from
+    slow code. Recorded for the runs of tests that have a max run time or are exclusive.
+*/
+struct TimingConditions {
+    enum Governor : uint8_t {
+        UnknownGovernor,
+        Performance,
+        Powersave,
+        Ondemand,
+        Conservative,
+        Schedutil,
+        Userspace,
+        OtherGovernor
+    };
+
+    int32_t cpu = -1; // the CPU the call finished on
+    Governor governor = UnknownGovernor; // cpufreq governor of that CPU
+    uint32_t frequency = 0; // current frequency of that CPU in kHz, 0 if unknown
+    double load = 0; // 1-minute load average per online CPU
+    uint64_t preemptions = 0; // involuntary context switches during the call
+    bool pinned = false; // run alone on a reserved CPU, see Test::Exclusive
+    bool noisy = false; // preempted or the machine was overloaded, the run time isn't trustworthy
+};
+
+// What the caches hold when a tested function is called, see FunctionTestBase::SetCacheMode
+enum CacheMode : uint8_t {
+    UnchangedCache, // whatever the harness and the previous runs left
+    Cold, // evicted before the call
+    Warm // the function was called with the same arguments right before
+};
+
+// How the run time of a timed run was measured, see Timer
+struct TimerInfo {
+    std::chrono::nanoseconds overhead; // cost of the timing subtracted from the timed window
+    std::chrono::nanoseconds resolution; // smallest difference of the run time that isn't noise
+    uint32_t batch = 1; // calls timed together, the run time is per call
+};
+
 template<template<typename> class allocator = std::allocator>
 struct _FunctionEntry {
     typedef _UserObject<allocator> UO;
@@ -162,12 +222,35 @@ struct _FunctionEntry {
     std::optional<UO> object_after_expected;
     std::optional<std::chrono::nanoseconds> max_run_time;
     std::chrono::nanoseconds run_time;
+    std::optional<IOCounts> io_counts;
+    std::optional<uint64_t> max_read_calls;
+    std::optional<uint64_t> max_write_calls;
+    std::optional<OperationCounts> operation_counts;
+    std::optional<uint64_t> max_comparisons;
+    std::optional<uint64_t> max_allocations;
+    std::optional<TimingConditions> conditions;
+    std::optional<TimerInfo> timer;
+    CacheMode cache_mode = UnchangedCache;
     std::chrono::duration<double> timeout;
     ForkStatus status = OK;
     bool result;
 
     _FunctionEntry() {}
 
+    // The optional objects and limits in a fixed order, for code that handles them all alike
+    static constexpr std::array<std::optional<UO> _FunctionEntry::*, 13> Objects() {
+        return {
+            &_FunctionEntry::input, &_FunctionEntry::output, &_FunctionEntry::output_expected,
+            &_FunctionEntry::error, &_FunctionEntry::error_expected,
+            &_FunctionEntry::arguments, &_FunctionEntry::arguments_after, &_FunctionEntry::arguments_after_expected,
+            &_FunctionEntry::return_value, &_FunctionEntry::return_value_expected,
+            &_FunctionEntry::object, &_FunctionEntry::object_after, &_FunctionEntry::object_after_expected
+        };
+    }
+    static constexpr std::array<std::optional<uint64_t> _FunctionEntry::*, 4> Limits() {
+        return { &_FunctionEntry::max_read_calls, &_FunctionEntry::max_write_calls, &_FunctionEntry::max_comparisons, &_FunctionEntry::max_allocations };
+    }
+
     template<template<typename> class T>
     _FunctionEntry(const _FunctionEntry<T>& f) {
         *this = f;
@@ -189,6 +272,15 @@ struct _FunctionEntry {
         object_after_expected = fe.object_after_expected;
         max_run_time = fe.max_run_time;
         run_time = fe.run_time;
+        io_counts = fe.io_counts;
+        max_read_calls = fe.max_read_calls;
+        max_write_calls = fe.max_write_calls;
+        operation_counts = fe.operation_counts;
+        max_comparisons = fe.max_comparisons;
+        max_allocations = fe.max_allocations;
+        conditions = fe.conditions;
+        timer = fe.timer;
+        cache_mode = fe.cache_mode;
         timeout = fe.timeout;
         status = fe.status;
         result = fe.result;
@@ -196,22 +288,340 @@ struct _FunctionEntry {
     }
 };
 using FunctionEntry = _FunctionEntry<>;
+
+// One level of threads of a SCALETEST
+struct ScaleEntry {
+    uint32_t threads;
+    std::chrono::nanoseconds run_time; // the fastest of the repeats
+    double throughput; // units of work per second
+    double speedup; // throughput relative to the first level, scaled by its threads
+    double efficiency; // speedup per thread
+    std::optional<double> target_speedup;
+    ForkStatus status = OK; // ERROR if the tested function threw
+    bool result;
+};
 template<template<typename> class allocator = std::allocator>
-using _FunctionData = std::vector<_FunctionEntry<allocator>, allocator<_FunctionEntry<allocator>>>;
+using _ScaleData = std::vector<ScaleEntry, allocator<ScaleEntry>>;
+using ScaleData = _ScaleData<>;
+
+/*
+    View of one run of _RunColumns with the members of _FunctionEntry. The objects and the larger
+    payloads point into the columns and are null when the run doesn't have them.
+*/
+template<template<typename> class allocator = std::allocator>
+struct _RunRow {
+    typedef _UserObject<allocator> UO;
+    const UO* input = nullptr;
+    const UO* output = nullptr;
+    const UO* output_expected = nullptr;
+    const UO* error = nullptr;
+    const UO* error_expected = nullptr;
+    const UO* arguments = nullptr;
+    const UO* arguments_after = nullptr;
+    const UO* arguments_after_expected = nullptr;
+    const UO* return_value = nullptr;
+    const UO* return_value_expected = nullptr;
+    const UO* object = nullptr;
+    const UO* object_after = nullptr;
+    const UO* object_after_expected = nullptr;
+    std::optional<std::chrono::nanoseconds> max_run_time;
+    std::chrono::nanoseconds run_time;
+    const IOCounts* io_counts = nullptr;
+    std::optional<uint64_t> max_read_calls;
+    std::optional<uint64_t> max_write_calls;
+    const OperationCounts* operation_counts = nullptr;
+    std::optional<uint64_t> max_comparisons;
+    std::optional<uint64_t> max_allocations;
+    const TimingConditions* conditions = nullptr;
+    const TimerInfo* timer = nullptr;
+    CacheMode cache_mode = UnchangedCache;
+    std::chrono::duration<double> timeout;
+    ForkStatus status = OK;
+    bool result;
+
+    // In the order of _FunctionEntry::Objects() and _FunctionEntry::Limits()
+    static constexpr std::array<const UO* _RunRow::*, 13> Objects() {
+        return {
+            &_RunRow::input, &_RunRow::output, &_RunRow::output_expected,
+            &_RunRow::error, &_RunRow::error_expected,
+            &_RunRow::arguments, &_RunRow::arguments_after, &_RunRow::arguments_after_expected,
+            &_RunRow::return_value, &_RunRow::return_value_expected,
+            &_RunRow::object, &_RunRow::object_after, &_RunRow::object_after_expected
+        };
+    }
+    static constexpr std::array<std::optional<uint64_t> _RunRow::*, 4> Limits() {
+        return { &_RunRow::max_read_calls, &_RunRow::max_write_calls, &_RunRow::max_comparisons, &_RunRow::max_allocations };
+    }
+};
+
+/*
+    Results of the runs of a function test, stored by column.
+    The dense columns hold one value per run, so that summaries and points don't walk full entries.
+    The counters are dense once any run has them, the rarer optional payloads are in sparse side tables.
+    Runs are stored from FunctionEntry objects, by their index so that they may arrive in any order,
+    and read back as _RunRow views.
+*/
+template<template<typename> class allocator = std::allocator>
+struct _RunColumns {
+    template<typename T>
+    using column = std::vector<T, allocator<T>>;
+    // (run index, value) ordered by the index
+    template<typename T>
+    using side_table = column<std::pair<uint32_t, T>>;
+    typedef _UserObject<allocator> UO;
+    typedef _RunRow<allocator> Row;
+
+    enum Counters : uint8_t {
+        IOCounted = 1,
+        OperationsCounted = 2
+    };
+
+    column<uint8_t> status; // ForkStatus
+    column<bool> result;
+    column<int64_t> run_time; // nanoseconds
+    column<double> timeout; // seconds
+    column<uint8_t> cache_mode; // CacheMode
+    column<uint8_t> counted; // Counters present in the run
+    column<IOCounts> io_counts; // empty until a run has them
+    column<OperationCounts> operation_counts; // empty until a run has them
+
+    std::array<side_table<UO>, 13> objects; // in the order of Entry::Objects()
+    std::array<side_table<uint64_t>, 4> limits; // in the order of Entry::Limits()
+    side_table<int64_t> max_run_time; // nanoseconds
+    side_table<TimingConditions> conditions;
+    side_table<TimerInfo> timer;
+
+    _RunColumns() {}
+
+    template<template<typename> class T>
+    _RunColumns(const _RunColumns<T>& c) {
+        *this = c;
+    }
+    template<template<typename> class T>
+    _RunColumns& operator=(const _RunColumns<T>& c) {
+        status.assign(c.status.begin(), c.status.end());
+        result.assign(c.result.begin(), c.result.end());
+        run_time.assign(c.run_time.begin(), c.run_time.end());
+        timeout.assign(c.timeout.begin(), c.timeout.end());
+        cache_mode.assign(c.cache_mode.begin(), c.cache_mode.end());
+        counted.assign(c.counted.begin(), c.counted.end());
+        io_counts.assign(c.io_counts.begin(), c.io_counts.end());
+        operation_counts.assign(c.operation_counts.begin(), c.operation_counts.end());
+        for(size_t i = 0; i < objects.size(); i++)
+            objects[i].assign(c.objects[i].begin(), c.objects[i].end());
+        for(size_t i = 0; i < limits.size(); i++)
+            limits[i].assign(c.limits[i].begin(), c.limits[i].end());
+        max_run_time.assign(c.max_run_time.begin(), c.max_run_time.end());
+        conditions.assign(c.conditions.begin(), c.conditions.end());
+        timer.assign(c.timer.begin(), c.timer.end());
+        return *this;
+    }
+
+    // Makes room for 'runs' runs, each of which is then stored once with Set
+    void Resize(size_t runs) {
+        status.resize(runs);
+        result.resize(runs);
+        run_time.resize(runs);
+        timeout.resize(runs);
+        cache_mode.resize(runs);
+        counted.resize(runs);
+        if(!io_counts.empty())
+            io_counts.resize(runs);
+        if(!operation_counts.empty())
+            operation_counts.resize(runs);
+    }
+
+    // Stores run 'index', which hasn't been stored yet
+    template<template<typename> class T>
+    void Set(size_t index, const _FunctionEntry<T>& e) {
+        status[index] = e.status;
+        result[index] = e.result;
+        run_time[index] = e.run_time.count();
+        timeout[index] = e.timeout.count();
+        cache_mode[index] = e.cache_mode;
+        counted[index] = (e.io_counts ? IOCounted : 0) | (e.operation_counts ? OperationsCounted : 0);
+        if(e.io_counts) {
+            io_counts.resize(Size());
+            io_counts[index] = *e.io_counts;
+        }
+        if(e.operation_counts) {
+            operation_counts.resize(Size());
+            operation_counts[index] = *e.operation_counts;
+        }
+
+        auto entry_objects = _FunctionEntry<T>::Objects();
+        for(size_t i = 0; i < objects.size(); i++)
+            if(auto& o = e.*entry_objects[i])
+                Insert(objects[i], index, *o);
+        auto entry_limits = _FunctionEntry<T>::Limits();
+        for(size_t i = 0; i < limits.size(); i++)
+            if(auto& max = e.*entry_limits[i])
+                Insert(limits[i], index, *max);
+        if(e.max_run_time)
+            Insert(max_run_time, index, e.max_run_time->count());
+        if(e.conditions)
+            Insert(conditions, index, *e.conditions);
+        if(e.timer)
+            Insert(timer, index, *e.timer);
+    }
+
+    template<template<typename> class T>
+    void Add(const _FunctionEntry<T>& e) {
+        Resize(Size() + 1);
+        Set(Size() - 1, e);
+    }
+
+    // Run 'index', its payloads are looked up from the side tables
+    Row Get(size_t index) const {
+        Row row = Dense(index);
+        auto row_objects = Row::Objects();
+        for(size_t i = 0; i < objects.size(); i++)
+            row.*row_objects[i] = Find(objects[i], index);
+        auto row_limits = Row::Limits();
+        for(size_t i = 0; i < limits.size(); i++)
+            if(auto max = Find(limits[i], index))
+                row.*row_limits[i] = *max;
+        if(auto max = Find(max_run_time, index))
+            row.max_run_time = std::chrono::nanoseconds(*max);
+        row.conditions = Find(conditions, index);
+        row.timer = Find(timer, index);
+        return row;
+    }
+
+    // Calls 'f' with each run in order, walking the side tables along instead of searching them
+    template<typename F>
+    void ForEachRow(F&& f) const {
+        std::array<size_t, 13> object_pos{};
+        std::array<size_t, 4> limit_pos{};
+        size_t max_run_time_pos = 0, conditions_pos = 0, timer_pos = 0;
+        auto row_objects = Row::Objects();
+        auto row_limits = Row::Limits();
+        for(size_t index = 0; index < Size(); index++) {
+            Row row = Dense(index);
+            for(size_t i = 0; i < objects.size(); i++)
+                row.*row_objects[i] = Next(objects[i], object_pos[i], index);
+            for(size_t i = 0; i < limits.size(); i++)
+                if(auto max = Next(limits[i], limit_pos[i], index))
+                    row.*row_limits[i] = *max;
+            if(auto max = Next(max_run_time, max_run_time_pos, index))
+                row.max_run_time = std::chrono::nanoseconds(*max);
+            row.conditions = Next(conditions, conditions_pos, index);
+            row.timer = Next(timer, timer_pos, index);
+            f(row);
+        }
+    }
+
+    void Swap(_RunColumns& other) {
+        status.swap(other.status);
+        result.swap(other.result);
+        run_time.swap(other.run_time);
+        timeout.swap(other.timeout);
+        cache_mode.swap(other.cache_mode);
+        counted.swap(other.counted);
+        io_counts.swap(other.io_counts);
+        operation_counts.swap(other.operation_counts);
+        objects.swap(other.objects);
+        limits.swap(other.limits);
+        max_run_time.swap(other.max_run_time);
+        conditions.swap(other.conditions);
+        timer.swap(other.timer);
+    }
+
+    size_t Size() const { return status.size(); }
+    size_t Passed() const { return std::count(result.begin(), result.end(), true); }
+    size_t Count(ForkStatus s) const { return std::count(status.begin(), status.end(), s); }
+    std::chrono::nanoseconds TotalRunTime() const {
+        return std::chrono::nanoseconds(std::accumulate(run_time.begin(), run_time.end(), int64_t(0)));
+    }
+    std::chrono::nanoseconds MaxRunTime() const {
+        auto it = std::max_element(run_time.begin(), run_time.end());
+        return std::chrono::nanoseconds(it == run_time.end() ? 0 : *it);
+    }
+private:
+    // The dense columns of run 'index'
+    Row Dense(size_t index) const {
+        Row row;
+        row.status = ForkStatus(status[index]);
+        row.result = result[index];
+        row.run_time = std::chrono::nanoseconds(run_time[index]);
+        row.timeout = std::chrono::duration<double>(timeout[index]);
+        row.cache_mode = CacheMode(cache_mode[index]);
+        if(counted[index] & IOCounted)
+            row.io_counts = &io_counts[index];
+        if(counted[index] & OperationsCounted)
+            row.operation_counts = &operation_counts[index];
+        return row;
+    }
+
+    // Runs mostly finish in order, so the value usually goes to the end
+    template<typename T, typename V>
+    static void Insert(side_table<T>& table, size_t index, const V& value) {
+        auto it = table.end();
+        while(it != table.begin() && std::prev(it)->first > index)
+            --it;
+        table.emplace(it, index, value);
+    }
+    template<typename T>
+    static const T* Find(const side_table<T>& table, size_t index) {
+        auto it = std::lower_bound(table.begin(), table.end(), index, [](const auto& a, size_t i) { return a.first < i; });
+        return it != table.end() && it->first == index ? &it->second : nullptr;
+    }
+    // The value of run 'index' at 'pos', moving 'pos' past it. The runs are visited in order
+    template<typename T>
+    static const T* Next(const side_table<T>& table, size_t& pos, size_t index) {
+        if(pos == table.size() || table[pos].first != index)
+            return nullptr;
+        return &table[pos++].second;
+    }
+};
+using RunColumns = _RunColumns<>;
+template<template<typename> class allocator = std::allocator>
+using _FunctionData = _RunColumns<allocator>;
 using FunctionData = _FunctionData<>;
 
+// Totals of the runs of all the function tests of a test
+struct RunSummary {
+    size_t runs = 0;
+    size_t passed = 0;
+    size_t timed_out = 0;
+    size_t crashed = 0;
+    std::chrono::nanoseconds total_run_time{0};
+    std::chrono::nanoseconds max_run_time{0};
+
+    template<template<typename> class A>
+    void Add(const _RunColumns<A>& c) {
+        runs += c.Size();
+        passed += c.Passed();
+        timed_out += c.Count(TIMEDOUT);
+        crashed += c.Count(ERROR);
+        total_run_time += c.TotalRunTime();
+        max_run_time = std::max(max_run_time, c.MaxRunTime());
+    }
+};
+
+template<template<typename> class allocator>
+struct _ReportStream {
+    typedef std::basic_stringstream<char, std::char_traits<char>, allocator<char>> type;
+};
+// Info streams are handed to the tests as std::stringstream, so they stay on the heap
+template<>
+struct _ReportStream<arena_allocator> {
+    typedef std::stringstream type;
+};
+
 template<template<typename> class allocator = std::allocator>
 struct _TestReport {
-    typedef std::basic_stringstream<char, std::char_traits<char>, allocator<char>> stringstream;
+    typedef typename _ReportStream<allocator>::type stringstream;
     stringstream info_stream;
 
-    std::variant<_EqualsData<allocator>, _TrueData<allocator>, _FalseData<allocator>, _CaseData<allocator>, _FunctionData<allocator>> data;
+    std::variant<_EqualsData<allocator>, _TrueData<allocator>, _FalseData<allocator>, _CaseData<allocator>, _FunctionData<allocator>, _ScaleData<allocator>> data;
 
     _TestReport(const _TestReport& r) : data(r.data) { info_stream << r.info_stream.str(); }
     template<typename T>
     _TestReport(const T& d) : data(d) {}
     template<template<typename> class T>
     _TestReport(const _TestReport<T>& r) {
+        info_stream << r.info_stream.str();
         switch (r.data.index()) {
         case 0:
             data = std::get<0>(r.data);
@@ -226,9 +636,12 @@ struct _TestReport {
             auto& vec = std::get<3>(r.data);
             data = _CaseData<allocator>(vec.begin(), vec.end());
             break;
-        } case 4: {
-            auto& vec = std::get<4>(r.data);
-            data = _FunctionData<allocator>(vec.begin(), vec.end());
+        } case 4:
+            data = _FunctionData<allocator>(std::get<4>(r.data));
+            break;
+        case 5: {
+            auto& vec = std::get<5>(r.data);
+            data = _ScaleData<allocator>(vec.begin(), vec.end());
             break;
         } default:
             break;
@@ -303,7 +716,7 @@ struct _TestData {
 
     std::vector<TReport, allocator<TReport>> reports;
     GradingMethod grading_method = Partial;
-    string output_format = "vertical";
+    std::string output_format = "vertical"; // an option rather than a result, so it stays out of the arena
     TestStatus status = NotStarted;
 
     double points = 0;
@@ -316,33 +729,21 @@ struct _TestData {
     int incorrect = 0;
 
     _TestData(double points, Prerequisite prerequisite) : prerequisite(prerequisite), max_points(points) {}
-    template<template<typename> class T>
-    _TestData(const _TestData<T>& td) {
-        reports = std::vector<TReport, allocator<TReport>>(td.reports.begin(), td.reports.end());
-        grading_method = td.grading_method;
-        output_format = td.output_format;
-        status = td.status;
-        points = td.points;
-        max_points = td.max_points;
-        sout = td.sout;
-        serr = td.serr;
-        correct = td.correct;
-        incorrect = td.incorrect;
-        prerequisite = td.prerequisite;
+
+    // Drops the results and frees their memory, keeping the points and status for prerequisites
+    void ClearResults() {
+        decltype(reports)().swap(reports);
+        string().swap(sout);
+        string().swap(serr);
     }
-    template<template<typename> class T>
-    _TestData& operator=(const _TestData<T>& td) {
-        reports = std::vector<TReport, allocator<TReport>>(td.reports.begin(), td.reports.end());
-        grading_method = td.grading_method;
-        output_format = td.output_format;
-        status = td.status;
-        points = td.points;
-        max_points = td.max_points;
-        sout = td.sout;
-        serr = td.serr;
-        correct = td.correct;
-        incorrect = td.incorrect;
-        return *this;
+
+    // Totals of the runs of the FunctionData reports, from their columns
+    RunSummary Runs() const {
+        RunSummary summary;
+        for(auto& r : reports)
+            if(auto d = std::get_if<_FunctionData<allocator>>(&r.data))
+                summary.Add(*d);
+        return summary;
     }
 
     void CalculatePoints() {
@@ -382,13 +783,35 @@ class Test {
 
     void RunTest(); // Runs the test and takes care of result logging to Formatter
 protected:
-    TestData data_;
+    _TestData<arena_allocator> data_; // Results live in an arena that is released after the test has been reported
     std::string suite_;
     std::string test_;
-
-    TestReport& AddReport(TestReport& report);
+    int report_stream_ = -1; // If set, reports are also written to this file descriptor as they are added
+    std::unordered_map<std::string, size_t> reference_calls_; // Number of Reference calls made by the test so far for each inputs
+    bool reference_checked_ = false; // Whether a replayed Reference value has been checked against the reference
+
+    _TestReport<arena_allocator>& AddReport(TestReport& report);
+    // Writes report 'index' to report_stream_ as a length-prefixed frame: u32 index followed by the report
+    void StreamReport(size_t index);
+    // Adds the reports from the frames in 'stream', keeping the last frame of each index
+    void AddStreamedReports(std::string_view stream);
     void SetGradingMethod(GradingMethod method);
     void OutputFormat(std::string format);
+    /*
+        Runs the rest of the test alone on a CPU reserved with --pin-cpus, or pinned to the current CPU without it.
+        Waits for the exclusive tests of other gcheck processes on the host, and disables parallel runs.
+        The conditions of the machine are recorded for every run.
+    */
+    void Exclusive();
+    bool exclusive_ = false;
+
+    /*
+        Returns reference(). While a reference cache is being recorded the value is stored in it, and while one
+        is replayed the stored value is returned without calling reference. Calls are matched by 'inputs', which
+        should be the stringified inputs of the reference, and by their order among the calls of the test with the same inputs.
+    */
+    template<typename F>
+    auto Reference(F&& reference, std::string_view inputs) -> std::decay_t<decltype(reference())>;
 
 public:
     Test(const TestInfo& info);
@@ -400,7 +823,38 @@ public:
     static bool do_safe_run_;
 
     static bool RunTests();
+    // Runs the tests once for each shared object in 'paths', see Submission. Returns false if some produced no report
+    static bool RunSubmissions(const std::vector<std::string>& paths);
     static Test* FindTest(std::string suite, std::string test);
+    // Checksum of the suite and test names in order, identifies the test program in caches
+    static uint64_t Signature();
 };
 
+template<typename F>
+auto Test::Reference(F&& reference, std::string_view inputs) -> std::decay_t<decltype(reference())> {
+    typedef std::decay_t<decltype(reference())> T;
+    if constexpr(ReferenceCache::IsCacheable<T>) {
+        if(ReferenceCache::cache) {
+            size_t index = reference_calls_[std::string(inputs)]++;
+            std::string key = suite_ + '/' + test_ + '#' + std::to_string(index) + ':' + std::string(inputs);
+            if(ReferenceCache::cache->GetMode() == ReferenceCache::Replay) {
+                // the first value of each test is computed anyway to check that the reference hasn't changed
+                if(!reference_checked_) {
+                    reference_checked_ = true;
+                    T value = reference();
+                    ReferenceCache::cache->Verify(key, value);
+                    return value;
+                }
+                if(auto value = ReferenceCache::cache->Load<T>(key))
+                    return *value;
+                return reference();
+            }
+            T value = reference();
+            ReferenceCache::cache->Store(key, value);
+            return value;
+        }
+    }
+    return reference();
+}
+
 }
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+namespace gcheck {
+
+/*
+    Per-report table of unique values for deduplicating reports.
+    While a table is set as InternTable::table, the report writers write UserObjects as
+    ids of the table entries instead of inline. Equal values are the ones with equal encodings.
+    Each test is rendered under its own key, and an entry is kept only while some key's latest
+    rendering refers to it, so the table holds exactly the values the report uses.
+*/
+class InternTable {
+public:
+    static InternTable* table;
+
+    struct Entry {
+        std::string encoded; // the value as written inline in the report
+        size_t references = 0;
+    };
+
+    // Starts recording the references of a new rendering of 'key', dropping those of its previous one
+    void Render(const std::string& key);
+    // Refers to the value with this inline encoding from the current rendering and returns its id
+    size_t Intern(std::string encoded);
+
+    // The referred values by id
+    const std::map<size_t, Entry>& Entries() const { return entries_; }
+    size_t Size() const { return entries_.size(); }
+    void Clear();
+private:
+    std::map<size_t, Entry> entries_;
+    std::unordered_map<std::string_view, size_t> ids_; // refer to the encodings in entries_
+    std::map<std::string, std::vector<size_t>> renders_; // ids referred to by the latest rendering of each key
+    std::vector<size_t>* current_ = nullptr;
+    size_t next_id_ = 0;
+};
+
+} // gcheck
@@ -15,12 +15,7 @@ namespace gcheck {
 
 class IOPlugin {
 public:
-    template<typename... Args>
-    IOPlugin(FunctionTest<Args...>* test) : tout_(false), terr_(false), tin_(false) {
-        test->AddResetTest([this](){ this->ResetTestVars(); });
-        test->AddPreRun([this](auto&&... args){ this->PreRun(std::forward<decltype(args)>(args)...); });
-        test->AddPostRun([this](auto&&... args){ this->PostRun(std::forward<decltype(args)>(args)...); });
-    }
+    IOPlugin(FunctionTestBase* test);
 protected:
     StdoutCapturer tout_;
     StderrCapturer terr_;
@@ -38,40 +33,14 @@ protected:
     // Sets the expected error (stderr) of tested function
     void SetError(const std::string& str) { expected_error_ = str; }
 
-    void ResetTestVars() {
-        input_.reset();
-        expected_output_.reset();
-        expected_error_.reset();
-        do_close = false;
-    }
+    void ResetTestVars();
 private:
-    void PreRun(size_t, FunctionEntry&) {
-        if(input_) {
-            tin_.Capture();
-            tin_.Write(*input_);
-            if(do_close) tin_.Close();
-        }
-
-        tout_.Capture();
-        terr_.Capture();
-    }
-    void PostRun(size_t, FunctionEntry& entry) {
-        tout_.Restore();
-        terr_.Restore();
-        tin_.Restore();
-
-        if(input_) entry.input = *input_;
-
-        std::string outstr = tout_.str();
-        std::string errstr = terr_.str();
-        entry.output = outstr;
-        if(expected_output_)
-            entry.output_expected = *expected_output_;
-        entry.error = errstr;
-        if(expected_error_)
-            entry.error_expected = *expected_error_;
-        entry.result = entry.result && (!expected_output_ || *expected_output_ == outstr) && (!expected_error_ || *expected_error_ == errstr);
-    }
+    void PreRun(size_t, FunctionEntry&);
+    // Gives the input to the standard input again
+    void Inject();
+    // Drops the output of the warm-up call and gives it the input again
+    void ResetWarmUp();
+    void PostRun(size_t, FunctionEntry& entry);
 };
 
 /*
@@ -111,11 +80,22 @@ private:
         using gcheck::FunctionTest<ReturnT, Args...>::AddPreRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::AddPostRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::IOTest<ReturnT, Args...>::SetInput; \
         using gcheck::IOTest<ReturnT, Args...>::SetOutput; \
         using gcheck::IOTest<ReturnT, Args...>::SetError; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(std::function<ReturnT(Args...)> func) : gcheck::IOTest<ReturnT, Args...>(gcheck::TestInfo(#suitename, #testname, __TAIL(__VA_ARGS__)), num_runs, func) { } \
@@ -138,11 +118,22 @@ private:
         using gcheck::FunctionTest<ReturnT, Args...>::AddPreRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::AddPostRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::IOTest<ReturnT, Args...>::SetInput; \
         using gcheck::IOTest<ReturnT, Args...>::SetOutput; \
         using gcheck::IOTest<ReturnT, Args...>::SetError; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(std::function<ReturnT(Args...)> func) : gcheck::IOTest<ReturnT, Args...>(gcheck::TestInfo(#suitename, #testname), num_runs, func) { } \
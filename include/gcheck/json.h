@@ -36,15 +36,25 @@ struct _CaseEntry;
 template<template<typename> class allocator>
 struct _FunctionEntry;
 
+template<template<typename> class allocator>
+struct _RunRow;
+
 enum TestStatus : int;
 template<template<typename> class allocator>
 struct _TestData;
 
+template<template<typename> class allocator>
+struct _RunColumns;
+
+struct RunSummary;
+
 template<template<typename> class allocator>
 class _UserObject;
 
 enum ForkStatus : unsigned int;
 
+struct ScaleEntry;
+
 class Prerequisite;
 
 template<template<typename> class allocator = std::allocator>
@@ -71,14 +81,26 @@ public:
     _JSON(const std::string& key, const char* value) : _JSON(key, _JSON(value)) {}
     _JSON(bool b) : string(b ? "true" : "false") {}
 
-    _JSON(const _TestReport<std::allocator>& r);
-    _JSON(const _CaseEntry<std::allocator>& e);
-    _JSON(const _FunctionEntry<std::allocator>& e);
-    _JSON(const _TestData<std::allocator>& data);
-    _JSON(const _UserObject<std::allocator>& o);
+    // Report types, instantiated for std::allocator and arena_allocator in json.cpp
+    template<template<typename> class A>
+    _JSON(const _TestReport<A>& r);
+    template<template<typename> class A>
+    _JSON(const _CaseEntry<A>& e);
+    template<template<typename> class A>
+    _JSON(const _FunctionEntry<A>& e);
+    template<template<typename> class A>
+    _JSON(const _RunRow<A>& e);
+    template<template<typename> class A>
+    _JSON(const _TestData<A>& data);
+    template<template<typename> class A>
+    _JSON(const _RunColumns<A>& runs);
+    template<template<typename> class A>
+    _JSON(const _UserObject<A>& o);
+    _JSON(const RunSummary& runs);
     _JSON(const TestStatus& status);
     _JSON(const Prerequisite& o);
     _JSON(const ForkStatus& s);
+    _JSON(const ScaleEntry& e);
 
     template<typename T, typename SFINAE = typename std::enable_if_t<!has_tojson<T>::value && !has_tostring<T>::value && !has_std_tostring<T>::value>, typename A = SFINAE, typename A2 = SFINAE, typename A3 = SFINAE>
     _JSON(const T&) : _JSON() {}
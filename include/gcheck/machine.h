@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gcheck {
+
+struct TimingConditions;
+
+/*
+    CPU placement of the harness. With --pin-cpus the listed CPUs are reserved for exclusive tests:
+    the rest of the harness runs on the other CPUs, and an exclusive test runs alone on one reserved CPU
+    while holding a lock that the exclusive tests of other gcheck processes on the host wait for.
+    Only available on linux, elsewhere reserving does nothing. Also measures the conditions of timed calls,
+    controls what they find in the caches and scales the time limits to the speed of the host.
+*/
+class Machine {
+public:
+    // 'cpus' is a list like "2,3" or "2-3". Throws std::runtime_error if it isn't valid for this process
+    static void ReserveCPUs(const std::string& cpus);
+
+    // Pins the calling thread to a reserved CPU, or the CPU it is running on if none were reserved,
+    // once the lock is held. Blocks while other processes hold the locks
+    static void Acquire();
+    static void Release();
+    static bool Acquired() { return acquired_cpu_ >= 0; }
+
+    // Snapshots taken around a timed call
+    struct Snapshot {
+        long preemptions = 0;
+    };
+    static Snapshot Start();
+    static void Finish(const Snapshot& start, TimingConditions& conditions);
+
+    // Size of the largest CPU cache in bytes, 32 MiB if it isn't known
+    static size_t LastLevelCacheSize();
+    // Pushes the data of earlier calls out of the caches by writing and reading 'bytes', by default
+    // one and a half times the largest cache. The buffer is kept for the following calls
+    static void EvictCaches(size_t bytes = 0);
+
+    /*
+        Speed of the host in a short fixed CPU and memory benchmark, higher is faster. Scores are comparable
+        only between builds with the same benchmark. The score is cached per host in the user's cache
+        directory unless 'measure' is set, which measures it again and updates the cache.
+    */
+    static double Score(bool measure = false);
+    // Set by GCHECK_REFERENCE_SCORE to the score of the host the time limits were chosen on
+    static void SetReferenceScore(double score) { reference_score_ = score; }
+    // Overrides the factor of the time limits, e.g. with --time-scale
+    static void SetTimeScale(double scale) { time_scale_ = scale; time_scale_set_ = true; }
+    // Sets the factor to the reference score per the score of this host, if there is a reference and no override
+    static void CalibrateTimeScale();
+    // Factor that the timeouts and max run times of the tests are multiplied with, 1 by default
+    static double TimeScale() { return time_scale_; }
+    template<typename D>
+    static D ScaleTime(D time) { return std::chrono::duration_cast<D>(time * time_scale_); }
+private:
+    static std::vector<int> reserved_;
+    static int acquired_cpu_;
+    static int lock_fd_;
+    static double reference_score_;
+    static double time_scale_;
+    static bool time_scale_set_;
+};
+
+} // gcheck
+
+/*
+    Embeds the score (from running the tests with --machine-score) of the host that the timeouts and max run
+    times were chosen on, so that they are scaled to the speed of the host running the tests.
+    Used once in a test source file at namespace scope.
+*/
+#define GCHECK_REFERENCE_SCORE(score) \
+    namespace { const bool gcheck_reference_score_ = (gcheck::Machine::SetReferenceScore(score), true); }
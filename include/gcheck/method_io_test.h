@@ -44,6 +44,15 @@ private:
         using gcheck::FunctionTest<ReturnT, Args...>::GetLastArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::GetRunIndex; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetObject; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetObjectAfter; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetStateComparer; \
@@ -51,7 +60,9 @@ private:
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetOutput; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetError; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(const std::function<ReturnT(ObjectType*, Args...)>& func) : gcheck::MethodIOTest<ReturnT, ObjectType, Args...>(gcheck::TestInfo(#suitename, #testname, __TAIL(__VA_ARGS__)), num_runs, func) { } \
@@ -76,6 +87,15 @@ private:
         using gcheck::FunctionTest<ReturnT, Args...>::GetLastArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::GetRunIndex; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetObject; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetObjectAfter; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetStateComparer; \
@@ -83,7 +103,9 @@ private:
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetOutput; \
         using gcheck::MethodIOTest<ReturnT, ObjectType, Args...>::SetError; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(const std::function<ReturnT(ObjectType*, Args...)>& func) : gcheck::MethodIOTest<ReturnT, ObjectType, Args...>(gcheck::TestInfo(#suitename, #testname), num_runs, func) { } \
@@ -3,6 +3,7 @@
 #include <type_traits>
 #include <functional>
 #include <chrono>
+#include <memory>
 
 #include "macrotools.h"
 #include "gcheck.h"
@@ -16,11 +17,12 @@ template<typename ObjectType>
 class MethodPlugin {
 public:
     typedef std::tuple<bool, UserObject, UserObject> StateDiff;
-    template<typename... Args>
-    MethodPlugin(FunctionTest<Args...>* test) {
+    MethodPlugin(FunctionTestBase* test) {
         test->AddResetTest([this](){ this->ResetTestVars(); });
         test->AddPreRun([this](auto&&... args){ this->PreRun(std::forward<decltype(args)>(args)...); });
         test->AddPostRun([this](auto&&... args){ this->PostRun(std::forward<decltype(args)>(args)...); });
+        test->AddPreWarmUp([this](){ this->SaveObject(); });
+        test->AddPostWarmUp([this](){ this->RestoreObject(); });
     }
     ~MethodPlugin() {
         FreeObject();
@@ -54,6 +56,22 @@ protected:
     }
 private:
     std::function<StateDiff(const ObjectType&)> state_comparer_;
+    std::unique_ptr<ObjectType> saved_object_; // the object before the warm-up call
+
+    static constexpr bool restorable = std::is_copy_constructible_v<ObjectType> && std::is_copy_assignable_v<ObjectType>;
+    void SaveObject() {
+        if constexpr(restorable) {
+            if(object_)
+                saved_object_ = std::make_unique<ObjectType>(*object_);
+        }
+    }
+    void RestoreObject() {
+        if constexpr(restorable) {
+            if(object_ && saved_object_)
+                *object_ = *saved_object_;
+            saved_object_.reset();
+        }
+    }
 
     void FreeObject() {
         if(owns_object_) {
@@ -95,10 +113,23 @@ class MethodTest : public FunctionTest<ReturnT, Args...>, public MethodPlugin<Ob
 public:
     typedef std::tuple<bool, UserObject, UserObject> StateDiff;
     MethodTest(const TestInfo& info, int num_runs, const std::function<ReturnT(ObjectType*, Args...)>& func)
-            : FunctionTest<ReturnT, Args...>(info, num_runs, [this, func](Args&&... args){ return func(this->object_, std::forward<Args>(args)...); }),
+            : FunctionTest<ReturnT, Args...>(info, num_runs, Bind(this, func)),
             MethodPlugin<ObjectType>(this) { }
 
+protected:
+    // Through the same wrapper as the tested method, which the empty one ignores the object of
+    void CalibrateCall() override {
+        if constexpr(FunctionTest<ReturnT, Args...>::calibrates_signature)
+            FunctionTest<ReturnT, Args...>::CalibrateCall(Bind(this, EmptyFunction<ReturnT, ObjectType*, Args...>));
+        else
+            FunctionTest<ReturnT, Args...>::CalibrateCall(nullptr);
+    }
 private:
+    // The method as a function of the arguments, called on the object of the current run
+    static std::function<ReturnT(Args...)> Bind(MethodTest* test, std::function<ReturnT(ObjectType*, Args...)> func) {
+        return [test, func](Args&&... args){ return func(test->object_, std::forward<Args>(args)...); };
+    }
+
     using FunctionTest<ReturnT, Args...>::SetInputsAndOutputs;
     using FunctionTest<ReturnT, Args...>::AddReport;
     using FunctionTest<ReturnT, Args...>::RunOnce;
@@ -118,6 +149,7 @@ private:
     template<typename ReturnT, typename ObjectType, typename... Args> \
     class GCHECK_TEST_##suitename##_##testname : public gcheck::MethodTest<ReturnT, ObjectType, Args...> { \
         using gcheck::FunctionTest<ReturnT, Args...>::SetTimeout; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetRelativeTimeout; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArgumentsAfter; \
         using gcheck::FunctionTest<ReturnT, Args...>::IgnoreArgumentsAfter; \
@@ -127,11 +159,22 @@ private:
         using gcheck::FunctionTest<ReturnT, Args...>::AddPreRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::AddPostRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::MethodTest<ReturnT, ObjectType, Args...>::SetObject; \
         using gcheck::MethodTest<ReturnT, ObjectType, Args...>::SetObjectAfter; \
         using gcheck::MethodTest<ReturnT, ObjectType, Args...>::SetStateComparer; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(const std::function<ReturnT(ObjectType*, Args...)>& func) : gcheck::MethodTest<ReturnT, ObjectType, Args...>(gcheck::TestInfo(#suitename, #testname, __TAIL(__VA_ARGS__)), num_runs, func) { } \
@@ -149,6 +192,7 @@ private:
     template<typename ReturnT, typename ObjectType, typename... Args> \
     class GCHECK_TEST_##suitename##_##testname : public gcheck::MethodTest<ReturnT, ObjectType, Args...> { \
         using gcheck::FunctionTest<ReturnT, Args...>::SetTimeout; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetRelativeTimeout; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArguments; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetArgumentsAfter; \
         using gcheck::FunctionTest<ReturnT, Args...>::IgnoreArgumentsAfter; \
@@ -158,11 +202,22 @@ private:
         using gcheck::FunctionTest<ReturnT, Args...>::AddPreRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::AddPostRun; \
         using gcheck::FunctionTest<ReturnT, Args...>::SetMaxRunTime; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetBatch; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetCacheMode; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxReadSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxWriteSyscalls; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountIO; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxComparisons; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetMaxAllocations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::CountOperations; \
+        using gcheck::FunctionTest<ReturnT, Args...>::SetParallelRuns; \
         using gcheck::MethodTest<ReturnT, ObjectType, Args...>::SetObject; \
         using gcheck::MethodTest<ReturnT, ObjectType, Args...>::SetObjectAfter; \
         using gcheck::MethodTest<ReturnT, ObjectType, Args...>::SetStateComparer; \
         using gcheck::Test::OutputFormat; \
+        using gcheck::Test::Exclusive; \
         using gcheck::Test::SetGradingMethod; \
+        using gcheck::Test::Reference; \
         void SetInputsAndOutputs(); \
     public: \
         GCHECK_TEST_##suitename##_##testname(const std::function<ReturnT(ObjectType*, Args...)>& func) : gcheck::MethodTest<ReturnT, ObjectType, Args...>(gcheck::TestInfo(#suitename, #testname), num_runs, func) { } \
@@ -2,50 +2,255 @@
 
 #include <chrono>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <functional>
+#include <optional>
 #include "shared_allocator.h"
+#include "binary.h"
+#include "profiler.h"
 
 namespace gcheck {
 
 enum ForkStatus : unsigned int {
     OK,
     TIMEDOUT,
-    ERROR
+    ERROR,
+    OVERSIZED // the result didn't fit in the shared memory it is passed back in
 };
 
+// Console description of a run that didn't finish with OK
+inline const char* FailureText(ForkStatus status) {
+    switch(status) {
+    case TIMEDOUT:
+        return "Timed out";
+    case OVERSIZED:
+        return "Result too large";
+    default:
+        return "Crashed";
+    }
+}
+
 #if defined(__linux__)
 ForkStatus wait_timeout(pid_t pid, std::chrono::duration<double> time);
 
-template<template<template<typename...> class> class T, typename F, typename... Args>
-ForkStatus RunForked(std::chrono::duration<double> timeout, T<std::allocator>& data_out, size_t mem_size, F&& function, Args&&... args) {
+// Waits for the child 'pid' while collecting everything it writes to 'fd' into 'out'
+ForkStatus wait_stream(pid_t pid, int fd, std::chrono::duration<double> time, std::string& out);
+
+/*
+    Header of the record a forked child leaves in shared memory. Followed by 'size' bytes written by BinaryWriter.
+    'required' is zeroed before forking and set to the length of the result if it didn't fit.
+*/
+struct SharedRecord {
+    uint64_t size;
+    uint64_t checksum;
+    uint64_t required;
+};
+
+// Forks, adding a trace span for it in the parent
+inline pid_t TracedFork() {
+    auto start = Tracer::Enabled() ? Tracer::Now() : Tracer::TimePoint();
+    pid_t pid = fork();
+    if(pid != 0 && Tracer::Enabled())
+        Tracer::Complete("spawn", "fork", start);
+    return pid;
+}
+
+// Adds a trace event for a forked run that timed out, crashed or had a too large result
+inline ForkStatus TraceStatus(ForkStatus status) {
+    if(status != OK && Tracer::Enabled())
+        Tracer::Instant(status == TIMEDOUT ? "timeout" : status == OVERSIZED ? "oversized" : "crash", "fork");
+    return status;
+}
+
+// Writes 'data' as the record, or only the size it would need if it doesn't fit in 'capacity' bytes
+template<typename T>
+void WriteRecord(SharedRecord* record, size_t capacity, const T& data) {
+    TraceSpan span("write record", "serialize");
+    BinaryWriter writer;
+    writer.Write(data);
+    if(writer.str().length() > capacity) {
+        record->required = writer.str().length();
+        return;
+    }
+
+    std::memcpy(record + 1, writer.str().data(), writer.str().length());
+    record->size = writer.str().length();
+    record->checksum = Checksum(record + 1, record->size);
+}
+
+template<typename T>
+ForkStatus ReadRecord(const SharedRecord* record, size_t capacity, T& data) {
+    TraceSpan span("read record", "serialize");
+    if(record->required != 0)
+        return OVERSIZED;
+    if(record->size > capacity || Checksum(record + 1, record->size) != record->checksum)
+        return ERROR;
+
+    try {
+        BinaryReader(record + 1, record->size).Read(data);
+    } catch(const std::runtime_error&) {
+        return ERROR;
+    }
+    return OK;
+}
+
+/*
+    Runs 'function' in a forked process and passes 'data_out' back as a flat record in shared memory.
+    The record is relocatable, so the parent reads it in place without depending on the child's heap.
+    A record that doesn't fit in 'mem_size' bytes is reported as OVERSIZED and one that fails the checksum as ERROR.
+*/
+template<template<template<typename...> class> class T, template<typename> class allocator, typename F, typename... Args>
+ForkStatus RunForked(std::chrono::duration<double> timeout, T<allocator>& data_out, size_t mem_size, F&& function, Args&&... args) {
+    ProfileScope profile(Profiler::Fork);
+
     shared_manager sm;
     shared_manager::manager = &sm;
     sm.Realloc(mem_size);
 
-    pid_t pid = fork();
-    if(pid == 0) {
-        auto allocator = shared_allocator<T<shared_allocator>>();
-        auto data = allocator.allocate(1);
+    auto record = (SharedRecord*)sm.Memory();
+    auto capacity = mem_size - sizeof(SharedRecord);
+    record->required = 0;
 
+    pid_t pid = TracedFork();
+    if(pid == 0) {
         function(std::forward<Args>(args)...);
 
-        allocator.construct(data, data_out);
+        WriteRecord(record, capacity, data_out);
         exit(0);
     } else if(timeout != timeout.zero()) {
+        TraceSpan span("wait", "fork");
         ForkStatus status = wait_timeout(pid, timeout);
         if(status == TIMEDOUT || status == ERROR) {
-            return status;
+            return TraceStatus(status);
         }
     } else {
+        TraceSpan span("wait", "fork");
         int status;
         waitpid(pid, &status, WUNTRACED);
         if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
-            return ERROR;
+            return TraceStatus(ERROR);
     }
     (void)timeout;
 
-    data_out = *(T<shared_allocator>*)sm.Memory();
-    return OK;
+    return TraceStatus(ReadRecord(record, capacity, data_out));
+}
+
+/*
+    Like RunForked, but the child gets the write end of a pipe in 'stream_fd' while 'function' runs.
+    Whatever the child writes there is collected into 'stream', also when it crashes or times out,
+    so the caller can recover the partial results.
+*/
+template<template<template<typename...> class> class T, template<typename> class allocator, typename F, typename... Args>
+ForkStatus RunForkedStreaming(std::chrono::duration<double> timeout, T<allocator>& data_out, size_t mem_size, int& stream_fd, std::string& stream, F&& function, Args&&... args) {
+    ProfileScope profile(Profiler::Fork);
+
+    shared_manager sm;
+    shared_manager::manager = &sm;
+    sm.Realloc(mem_size);
+
+    auto record = (SharedRecord*)sm.Memory();
+    auto capacity = mem_size - sizeof(SharedRecord);
+    record->required = 0;
+
+    int fds[2];
+    if(pipe(fds) != 0)
+        return ERROR;
+
+    pid_t pid = TracedFork();
+    if(pid == 0) {
+        close(fds[0]);
+        stream_fd = fds[1];
+
+        function(std::forward<Args>(args)...);
+
+        WriteRecord(record, capacity, data_out);
+        exit(0);
+    }
+    close(fds[1]);
+
+    ForkStatus status;
+    {
+        TraceSpan span("wait", "fork");
+        status = wait_stream(pid, fds[0], timeout, stream);
+    }
+    close(fds[0]);
+    if(status != OK)
+        return TraceStatus(status);
+
+    return TraceStatus(ReadRecord(record, capacity, data_out));
 }
+
+/*
+    Runs functions in forked workers, at most 'workers' at a time.
+    Each worker passes its result back through its own slot of shared memory the same way as RunForked.
+*/
+class ForkPool {
+public:
+    ForkPool(size_t workers, size_t slot_size = 1024*1024);
+    ~ForkPool();
+
+    /*
+        Runs 'function' in a new worker once one is free. When the worker finishes, 'data_out' is read back
+        from it and 'done' is called with the status. 'data_out' has to stay alive until then.
+    */
+    template<typename T, typename F>
+    void Run(std::chrono::duration<double> timeout, T& data_out, F&& function, std::function<void(ForkStatus)> done) {
+        ProfileScope profile(Profiler::Fork);
+
+        size_t slot = Acquire();
+        SharedRecord* record = Slot(slot);
+        record->size = capacity_ + 1; // invalid until the worker writes it
+        record->required = 0;
+
+        BlockSIGCHLD();
+        pid_t pid = TracedFork();
+        if(pid == 0) {
+            sigprocmask(SIG_SETMASK, &old_mask_, NULL);
+            function();
+            WriteRecord(record, capacity_, data_out);
+            exit(0);
+        }
+
+        size_t capacity = capacity_;
+        Worker worker{pid, slot, std::nullopt, [record, capacity, &data_out, done](ForkStatus status) {
+            if(status == OK)
+                status = ReadRecord(record, capacity, data_out);
+            done(TraceStatus(status));
+        }};
+        if(timeout != timeout.zero())
+            worker.deadline = std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::nanoseconds>(timeout);
+        running_.push_back(std::move(worker));
+    }
+
+    // Waits for all the workers to finish and unblocks SIGCHLD
+    void Wait();
+private:
+    struct Worker {
+        pid_t pid;
+        size_t slot;
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        std::function<void(ForkStatus)> finish;
+    };
+
+    size_t workers_;
+    size_t slot_size_;
+    size_t capacity_;
+    shared_manager memory_;
+    std::vector<size_t> free_;
+    std::vector<Worker> running_;
+    sigset_t old_mask_;
+    bool blocked_ = false;
+
+    SharedRecord* Slot(size_t index) { return (SharedRecord*)((char*)memory_.Memory() + index*slot_size_); }
+    // Blocks SIGCHLD until Wait, saving the previous mask
+    void BlockSIGCHLD();
+    // Returns a free slot, waiting for a worker to finish if there is none
+    size_t Acquire();
+    // Finishes the workers that have exited or run out of time, waiting for one if none have
+    void Reap();
+};
 #endif
 
 } // gcheck
\ No newline at end of file
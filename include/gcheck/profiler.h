@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "trace.h"
+
+namespace gcheck {
+
+/*
+    Opt-in timing of the phases of the harness, enabled with --profile-harness.
+    Time is charged to the innermost phase that is open, so nested phases aren't counted twice
+    and the phases add up to the whole run. Everything is a no-op unless the profiler is enabled.
+*/
+class Profiler {
+public:
+    enum Phase {
+        Other,      // everything outside the phases below, e.g. scheduling the tests
+        TestBody,   // the body of the test and hooks not covered by the other phases
+        Setup,      // resetting the test and SetInputsAndOutputs
+        Call,       // the tested function, i.e. the sum of the measured run times
+        Stringify,  // copying, comparing and converting the arguments and return values
+        Capture,    // redirecting standard input and output and reading them back
+        Fork,       // running in forked processes, excluding the run times measured there
+        Report,     // serializing and saving the report
+        Console,    // the human readable output
+        NumPhases
+    };
+    typedef std::array<int64_t, NumPhases> Times; // nanoseconds
+
+    static void Enable();
+    static bool Enabled() { return enabled_; }
+
+    static const char* Name(Phase phase);
+
+    // Makes 'phase' current and returns the phase that was current before
+    static Phase Enter(Phase phase) {
+        Phase previous = current_;
+        if(enabled_)
+            Switch(phase);
+        return previous;
+    }
+    static void Leave(Phase previous) {
+        if(enabled_)
+            Switch(previous);
+    }
+    // Moves time already charged to 'from' to 'to', e.g. a run time measured in a forked process
+    static void Transfer(Phase from, Phase to, std::chrono::nanoseconds time);
+
+    // The time charged between these is saved for the test
+    static void StartTest();
+    static void FinishTest(const std::string& suite, const std::string& test);
+
+    // Time charged to each phase so far
+    static const Times& Total();
+    static const std::map<std::string, std::map<std::string, Times>>& Tests() { return tests_; }
+private:
+    static bool enabled_;
+    static Phase current_;
+    static std::chrono::steady_clock::time_point last_;
+    static Times times_;
+    static Times test_start_;
+    static std::map<std::string, std::map<std::string, Times>> tests_;
+
+    static void Switch(Phase phase) {
+        auto now = std::chrono::steady_clock::now();
+        times_[current_] += (now - last_).count();
+        last_ = now;
+        current_ = phase;
+    }
+};
+
+// Charges the time until the end of the scope to 'phase' and adds a trace span for it
+class ProfileScope {
+public:
+    ProfileScope(Profiler::Phase phase) : phase_(phase), previous_(Profiler::Enter(phase)) {
+        if(Tracer::Enabled())
+            start_ = Tracer::Now();
+    }
+    ~ProfileScope() {
+        Profiler::Leave(previous_);
+        if(Tracer::Enabled())
+            Tracer::Complete(Profiler::Name(phase_), "harness", start_);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+    Profiler::Phase phase_;
+    Profiler::Phase previous_;
+    Tracer::TimePoint start_;
+};
+
+} // gcheck
@@ -69,6 +69,8 @@ public:
     std::string str();
     FileCapturer& Restore();
     FileCapturer& Capture();
+    // Switches to a new temporary file, e.g. in a forked child so that it doesn't share the file with its siblings
+    FileCapturer& Reopen();
 };
 
 /*
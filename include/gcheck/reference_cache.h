@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <typeinfo>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+namespace gcheck {
+
+/*
+    Cache of values computed by reference solutions.
+    With --record-reference the values returned by Test::Reference are stored and written to a file at the end.
+    With --replay-reference the file is memory-mapped and the values are returned without calling the reference.
+    Values are keyed on the test and the stringified inputs of the call, so inputs that differ from the recorded
+    ones miss and are computed again. The first call of each test is computed anyway and compared with the
+    recorded value, if they differ the reference has changed and the whole cache is marked stale.
+    The file stores a checksum of its contents and of the test program's test list, a file that doesn't
+    match either is rejected when it is opened.
+*/
+class ReferenceCache {
+public:
+    static ReferenceCache* cache;
+
+    enum Mode { Record, Replay };
+
+    static const char magic[8];
+    static const uint32_t version;
+
+    // Opens 'filename' for replaying or prepares to record to it. Throws std::runtime_error if a replayed file is stale or corrupted
+    ReferenceCache(const std::string& filename, Mode mode, uint64_t signature);
+    ~ReferenceCache();
+
+    ReferenceCache(const ReferenceCache&) = delete;
+    ReferenceCache& operator=(const ReferenceCache&) = delete;
+
+    Mode GetMode() const { return mode_; }
+    // Number of replayed lookups that found no matching value and called the reference instead
+    size_t Misses() const { return misses_; }
+    // Whether a value computed while replaying differed from the recorded one
+    bool Stale() const { return stale_; }
+
+    // Values of these types are stored as their bytes
+    template<typename T>
+    static constexpr bool IsCacheable = std::is_same_v<T, std::string> || (std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T> && !std::is_pointer_v<T>);
+
+    template<typename T>
+    void Store(const std::string& key, const T& value);
+    // Returns the value stored for 'key', nothing if there is none of type T or the cache is stale
+    template<typename T>
+    std::optional<T> Load(const std::string& key);
+    // Marks the cache stale if the value stored for 'key' differs from 'value'
+    template<typename T>
+    void Verify(const std::string& key, const T& value);
+
+    // Writes the recorded values to the file
+    void Save() const;
+private:
+    struct Entry {
+        std::string_view type;
+        std::string_view value;
+    };
+
+    Mode mode_;
+    std::string filename_;
+    uint64_t signature_;
+    size_t misses_ = 0;
+    bool stale_ = false;
+
+    std::string recorded_; // entries in file layout while recording
+    uint32_t count_ = 0;
+
+    const char* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    std::string contents_; // the file when it can't be mapped
+    std::unordered_map<std::string_view, Entry> entries_;
+
+    template<typename T>
+    static std::string_view Bytes(const T& value) {
+        static_assert(IsCacheable<T>);
+        if constexpr(std::is_same_v<T, std::string>)
+            return value;
+        else
+            return std::string_view((const char*)&value, sizeof(T));
+    }
+
+    void StoreBytes(const std::string& key, std::string_view type, std::string_view value);
+    const Entry* Find(const std::string& key, std::string_view type) const;
+};
+
+template<typename T>
+void ReferenceCache::Store(const std::string& key, const T& value) {
+    StoreBytes(key, typeid(T).name(), Bytes(value));
+}
+
+template<typename T>
+std::optional<T> ReferenceCache::Load(const std::string& key) {
+    static_assert(IsCacheable<T>);
+    const Entry* entry = stale_ ? nullptr : Find(key, typeid(T).name());
+    if constexpr(std::is_same_v<T, std::string>) {
+        if(entry)
+            return std::string(entry->value);
+    } else {
+        if(entry && entry->value.length() == sizeof(T)) {
+            T value;
+            std::memcpy((void*)&value, entry->value.data(), sizeof(T));
+            return value;
+        }
+    }
+    misses_++;
+    return std::nullopt;
+}
+
+template<typename T>
+void ReferenceCache::Verify(const std::string& key, const T& value) {
+    const Entry* entry = Find(key, typeid(T).name());
+    if(entry && entry->value != Bytes(value))
+        stale_ = true;
+}
+
+} // gcheck
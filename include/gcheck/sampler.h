@@ -0,0 +1,57 @@
+#pragma once
+
+#include <csignal>
+#include <string>
+
+namespace gcheck {
+
+/*
+    Sampling profiler for the tested functions, enabled with --sample-profile <directory>. Only available on linux.
+    SIGPROF interrupts the process 'rate' times per second of CPU time and, while a tested function is running,
+    the stack is recorded by following the frame pointers, or with libunwind when the library is built with
+    GCHECK_LIBUNWIND. The tested code should be compiled with -fno-omit-frame-pointer.
+    The raw addresses are written to <directory>/<suite>.<test>.stacks next to the memory maps of the
+    processes, and tools/symbolize.py turns them into folded stacks for flame graph tools.
+*/
+class Sampler {
+public:
+    // Throws std::runtime_error if sampling isn't supported
+    static void Enable(const std::string& directory, int rate = 997);
+    static bool Enabled() { return enabled_; }
+
+    // Samples are recorded only between these
+    static void Start() {
+        if(!enabled_)
+            return;
+        if(!timer_running_)
+            StartTimer();
+        active_ = 1;
+    }
+    static void Stop() { active_ = 0; }
+
+    // The samples recorded between these are written for the test
+    static void StartTest(const std::string& suite, const std::string& test);
+    static void FinishTest();
+
+    // Prepended to the names of the files, e.g. the name of the submission
+    static void SetPrefix(const std::string& prefix) { prefix_ = prefix; }
+    // Saves the memory maps of this process for symbolization, needed again after loading shared objects
+    static void SaveMaps();
+    // Writes the samples of this process for the current test. Called at exit
+    static void Flush();
+private:
+    static bool enabled_;
+    static volatile sig_atomic_t active_;
+    static bool timer_running_;
+    static int rate_;
+    static int maps_pid_;
+    static std::string directory_;
+    static std::string prefix_;
+    static std::string test_file_;
+
+    static void StartTimer();
+    static void OnSignal(int, siginfo_t*, void* context);
+    static void ClearAfterFork();
+};
+
+} // gcheck
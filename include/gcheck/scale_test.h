@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#include "macrotools.h"
+#include "gcheck.h"
+
+namespace gcheck {
+
+/*
+    Measures how the throughput of multithreaded code scales with the number of threads. For each level of
+    threads the workload is timed 'repeats' times and the fastest run is kept. A tested function taking a
+    size_t is called once with the number of threads it should use, any other function is called
+    'calls per thread' times from each of the threads the harness starts. Each call is counted as 'work' units.
+    Speedups are relative to the first level and a level with a target speedup passes if it reaches it.
+    On linux the threads are pinned to the CPUs the process is allowed to run on.
+*/
+class ScaleTest : public Test {
+public:
+    template<typename F>
+    ScaleTest(const TestInfo& info, F&& function);
+
+protected:
+    // Levels of threads to run with. By default powers of two up to the number of CPUs available
+    void SetThreads(std::vector<size_t> threads) { threads_ = std::move(threads); }
+    // Limit for the default levels, allows levels beyond the number of CPUs
+    void SetMaxThreads(size_t threads) { max_threads_ = threads; }
+    void SetTargetSpeedup(size_t threads, double speedup) { target_speedups_[threads] = speedup; }
+    // Sets the target speedup of each level to 'efficiency' times its threads
+    void SetTargetEfficiency(double efficiency) { target_efficiency_ = efficiency; }
+    void SetWork(double units) { work_ = units; }
+    void SetRepeats(size_t repeats) { repeats_ = repeats; }
+    void SetCallsPerThread(size_t calls) { calls_per_thread_ = calls; }
+    void SetTimeout(double timeout) { timeout_ = timeout; }
+
+    virtual void SetUp() {} // The test body specified by user
+private:
+    std::function<void(size_t)> function_;
+    bool pass_threads_;
+
+    std::vector<size_t> threads_;
+    std::optional<size_t> max_threads_;
+    std::map<size_t, double> target_speedups_;
+    std::optional<double> target_efficiency_;
+    double work_ = 1;
+    size_t repeats_ = 3;
+    size_t calls_per_thread_ = 1;
+    double timeout_ = 60; // of all the levels together, so a deadlock in a forked run doesn't hang the tests
+
+    void ActualTest() override;
+    void Measure();
+    // Runs the workload once with 'threads' threads and returns the time it took
+    std::chrono::nanoseconds RunLevel(size_t threads, const std::vector<int>& cpus);
+};
+
+template<typename F>
+ScaleTest::ScaleTest(const TestInfo& info, F&& function) : Test(info) {
+    if constexpr(std::is_invocable_v<F, size_t>) {
+        function_ = [f = std::decay_t<F>(std::forward<F>(function))](size_t threads) { f(threads); };
+        pass_threads_ = true;
+    } else {
+        function_ = [f = std::decay_t<F>(std::forward<F>(function))](size_t) { f(); };
+        pass_threads_ = false;
+    }
+}
+
+} // gcheck
+
+#define _SCALETEST5(suitename, testname, tobetested, points, prerequisites) \
+    class GCHECK_TEST_##suitename##_##testname : public gcheck::ScaleTest { \
+        void SetUp() override; \
+    public: \
+        GCHECK_TEST_##suitename##_##testname() : ScaleTest(gcheck::TestInfo(#suitename, #testname, points, prerequisites), tobetested) { } \
+    }; \
+    GCHECK_TEST_##suitename##_##testname GCHECK_TESTVAR_##suitename##_##testname; \
+    void GCHECK_TEST_##suitename##_##testname::SetUp()
+#define _SCALETEST4(suitename, testname, tobetested, points) \
+    class GCHECK_TEST_##suitename##_##testname : public gcheck::ScaleTest { \
+        void SetUp() override; \
+    public: \
+        GCHECK_TEST_##suitename##_##testname() : ScaleTest(gcheck::TestInfo(#suitename, #testname, points), tobetested) { } \
+    }; \
+    GCHECK_TEST_##suitename##_##testname GCHECK_TESTVAR_##suitename##_##testname; \
+    void GCHECK_TEST_##suitename##_##testname::SetUp()
+#define _SCALETEST3(suitename, testname, tobetested) \
+    class GCHECK_TEST_##suitename##_##testname : public gcheck::ScaleTest { \
+        void SetUp() override; \
+    public: \
+        GCHECK_TEST_##suitename##_##testname() : ScaleTest(gcheck::TestInfo(#suitename, #testname), tobetested) { } \
+    }; \
+    GCHECK_TEST_##suitename##_##testname GCHECK_TESTVAR_##suitename##_##testname; \
+    void GCHECK_TEST_##suitename##_##testname::SetUp()
+
+// params: suite name, test name, function to be tested, points (optional), prerequisites (optional)
+#define SCALETEST(...) \
+    VFUNC(_SCALETEST, __VA_ARGS__)
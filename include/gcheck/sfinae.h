@@ -43,6 +43,11 @@ namespace {
     static auto has_end(int) -> sfinae_true<decltype(std::declval<T>().end())>;
     template<class T>
     static auto has_end(long) -> sfinae_false<T>;
+
+    template<class T>
+    static auto has_equal(int) -> sfinae_true<decltype(std::declval<const T&>() == std::declval<const T&>())>;
+    template<class T>
+    static auto has_equal(long) -> sfinae_false<T>;
     } // detail
 } // anonymous
 
@@ -54,6 +59,9 @@ struct has_std_tostring : decltype(detail::has_std_tostring<T>(0)){};
 template<class T>
 struct has_begin_end : decltype(detail::has_begin<T>(0) * detail::has_end<T>(0)){};
 
+template<class T>
+struct has_equal : decltype(detail::has_equal<T>(0)){};
+
 template<size_t... Args>
 auto index_tuple(std::index_sequence<Args...>) {
     return std::make_tuple(Args...);
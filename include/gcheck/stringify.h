@@ -49,32 +49,29 @@ std::string JSONEscape(std::string);
 
 template<typename C, typename Func>
 std::string Stringify(const C& container, Func func, const std::string& start, const std::string& separator, const std::string& end) {
-    std::stringstream ss;
-    ss << start;
+    std::string ret = start;
     for(auto it = container.begin(); it != container.end();) {
-        ss << func(*it);
+        ret += func(*it);
         if(++it != container.end()) {
-            ss << separator;
+            ret += separator;
         } else {
             break;
         }
     }
-    ss << end;
-    return ss.str();
+    ret += end;
+    return ret;
 }
 
 #define StringifyTuple(saveto, tuple, func, start, separator, end) \
     { \
         constexpr size_t n = sizeof...(Args); \
-        std::stringstream ss; \
-        ss << start; \
-        for_each(tuple, [&ss](int i, const auto& a) { \
-            ss << func(a); \
+        saveto = start; \
+        for_each(tuple, [&saveto](int i, const auto& a) { \
+            saveto += func(a); \
             if(i != n-1) \
-                ss << separator; \
+                saveto += separator; \
         }); \
-        ss << end; \
-        ret = ss.str(); \
+        saveto += end; \
     }
 
 template<template<typename> class allocator>
@@ -82,6 +79,12 @@ class _UserObject;
 using UserObject = _UserObject<std::allocator>;
 template<typename T>
 class DeltaCompare;
+template<typename T>
+class Counted;
+template<typename T, typename Compare>
+class CountingComparator;
+template<typename It>
+class CountingIterator;
 
 template<typename T>
 constexpr auto to_constructer() -> std::string(&)(const T&);
@@ -201,12 +204,27 @@ std::string toString(const DeltaCompare<T>& v) {
 }
 
 template<typename T>
-std::string toString(const std::vector<T>& cont) {
+std::string toString(const Counted<T>& v) {
+    return toString(v.Value());
+}
+
+template<typename T, typename Compare>
+std::string toString(const CountingComparator<T, Compare>&) {
+    return "comparator";
+}
+
+template<typename It>
+std::string toString(const CountingIterator<It>&) {
+    return "iterator";
+}
+
+template<typename T, typename Allocator>
+std::string toString(const std::vector<T, Allocator>& cont) {
     return Stringify(cont, to_stringer<T>(), "[", ", ", "]");
 }
 
-template<typename T>
-std::string toString(const std::list<T>& cont) {
+template<typename T, typename Allocator>
+std::string toString(const std::list<T, Allocator>& cont) {
     return Stringify(cont, to_stringer<T>(), "[", ", ", "]");
 }
 
@@ -3,4 +3,5 @@
 #include "method_test.h"
 #include "io_test.h"
 #include "method_io_test.h"
-#include "customtest.h"
\ No newline at end of file
+#include "customtest.h"
+#include "scale_test.h"
\ No newline at end of file
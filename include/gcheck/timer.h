@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#if defined(__linux__)
+    #include <time.h>
+#endif
+
+namespace gcheck {
+
+/*
+    Clock of the tested calls. On linux CLOCK_MONOTONIC_RAW, which isn't slewed by NTP and is read without
+    a system call. The costs of the timing itself are measured so that they can be subtracted from the runs.
+*/
+class Timer {
+public:
+    static std::chrono::nanoseconds Now() {
+#if defined(__linux__)
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return std::chrono::nanoseconds(int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec);
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+#endif
+    }
+
+    // Measures the cost of reading the clock, once per process. Called before the first timed call
+    static void Calibrate();
+
+    // Time between two readings of the clock with nothing in between
+    static std::chrono::nanoseconds ReadOverhead() { return read_overhead_; }
+    // Smallest difference of run times that can be told apart from the noise of the timing
+    static std::chrono::nanoseconds Resolution() { return resolution_; }
+
+    /*
+        Cost of one call(), the fastest of several timed loops. Inline so that it is compiled with the
+        flags of the tests, like the calls it stands for, and not with those of the library.
+    */
+    template<typename F>
+    static std::chrono::nanoseconds MeasureCall(F&& call) {
+        const uint32_t calls = 1000;
+        auto best = std::chrono::nanoseconds::max();
+        for(int i = 0; i < 20; i++) {
+            auto start = Now();
+            for(uint32_t j = 0; j < calls; j++)
+                call();
+            auto elapsed = Now() - start;
+            best = elapsed < best ? elapsed : best;
+        }
+        auto time = (best - read_overhead_) / calls;
+        return time.count() > 0 ? time : std::chrono::nanoseconds(0);
+    }
+
+    // The run time of one of 'calls' calls timed together for 'elapsed', without the overheads
+    static std::chrono::nanoseconds Correct(std::chrono::nanoseconds elapsed, uint32_t calls, std::chrono::nanoseconds call_overhead);
+private:
+    static bool calibrated_;
+    static std::chrono::nanoseconds read_overhead_;
+    static std::chrono::nanoseconds resolution_;
+};
+
+} // gcheck
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gcheck {
+
+/*
+    Writes a Chrome/Perfetto trace-event file, enabled with --trace <file>. Only available on linux.
+    Events are kept in a buffer per thread and written when the process exits, so every forked
+    process flushes its own events and gets its own track in the timeline.
+*/
+class Tracer {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // Throws std::runtime_error if the file can't be opened
+    static void Enable(const std::string& filename);
+    static bool Enabled() { return enabled_; }
+
+    static TimePoint Now() { return std::chrono::steady_clock::now(); }
+
+    // Adds a span from 'start' until now. 'name' has to outlive the tracer. 'args' is a JSON object or empty
+    static void Complete(const char* name, const char* category, TimePoint start, std::string args = "");
+    static void Complete(std::string name, const char* category, TimePoint start, std::string args = "");
+    // Adds an event without a duration
+    static void Instant(const char* name, const char* category, std::string args = "");
+
+    // Writes the events of this process to the file. Called at exit, and has to be called before _exit
+    static void Flush();
+private:
+    // Kept small and trivially copyable, the strings that have to be copied go to Buffer::strings
+    struct Event {
+        const char* name; // static names are not copied
+        const char* category;
+        int64_t start;
+        int64_t duration;
+        int32_t dynamic_name; // index to Buffer::strings used if 'name' is null
+        int32_t args; // index to Buffer::strings or -1
+        char phase;
+    };
+    struct Buffer {
+        std::vector<Event> events;
+        std::vector<std::string> strings;
+        uint32_t thread;
+
+        int32_t Store(std::string&& str) {
+            strings.push_back(std::move(str));
+            return strings.size() - 1;
+        }
+    };
+
+    static bool enabled_;
+    static int fd_;
+    static int root_pid_;
+
+    static Buffer& LocalBuffer();
+    static void ClearAfterFork();
+};
+
+// Adds a span for the time until the end of the scope
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category) : name_(name), category_(category) {
+        if(Tracer::Enabled())
+            start_ = Tracer::Now();
+    }
+    TraceSpan(std::string name, const char* category) : name_(nullptr), dynamic_name_(std::move(name)), category_(category) {
+        if(Tracer::Enabled())
+            start_ = Tracer::Now();
+    }
+    ~TraceSpan() {
+        if(!Tracer::Enabled())
+            return;
+        if(name_)
+            Tracer::Complete(name_, category_, start_, std::move(args_));
+        else
+            Tracer::Complete(std::move(dynamic_name_), category_, start_, std::move(args_));
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // Sets the arguments shown for the span, a JSON object
+    void SetArgs(std::string args) { args_ = std::move(args); }
+private:
+    const char* name_;
+    std::string dynamic_name_;
+    const char* category_;
+    Tracer::TimePoint start_;
+    std::string args_;
+};
+
+} // gcheck
@@ -47,6 +47,19 @@ public:
     template<typename... Args>
     _UserObject(const Args&... items) : _UserObject(std::tuple<Args...>(items...)) {}
 
+    // Constructs an object from its already rendered representations
+    static _UserObject FromParts(const std::string& string, const JSON& json = JSON(), const std::string& construct = "") {
+        _UserObject o;
+        o.as_string_ = string;
+        o.as_json_ = json;
+#ifdef GCHECK_CONSTRUCT_DATA
+        o.construct_ = construct;
+#else
+        (void)construct;
+#endif
+        return o;
+    }
+
     JSON json() const { return as_json_; }
     std::string string() const { return (std::string)as_string_; }
 #ifdef GCHECK_CONSTRUCT_DATA
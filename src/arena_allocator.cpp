@@ -0,0 +1,22 @@
+#include "arena_allocator.h"
+
+namespace gcheck {
+
+arena_manager* arena_manager::manager = nullptr;
+
+arena_manager::arena_manager(size_t initial_size) : resource_(initial_size) {}
+
+arena_manager::~arena_manager() {
+    if(manager == this)
+        manager = nullptr;
+}
+
+void* arena_manager::allocate(size_t n, size_t alignment) {
+    return resource_.allocate(n, alignment);
+}
+
+void arena_manager::Release() {
+    resource_.release();
+}
+
+} // gcheck
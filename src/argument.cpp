@@ -2,6 +2,10 @@
 
 namespace gcheck {
 
+std::array<std::atomic<uint64_t>, OperationCounter::NumOperations> OperationCounter::counters_;
+std::atomic<bool> OperationCounter::active_ = false;
+std::atomic<bool> OperationCounter::used_ = false;
+
 template class SequenceArgument<int>;
 template class SequenceArgument<unsigned int>;
 template class SequenceArgument<double>;
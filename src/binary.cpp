@@ -0,0 +1,472 @@
+#include "binary.h"
+
+#include "gcheck.h"
+#include "user_object.h"
+#include "intern_table.h"
+
+#include <stdexcept>
+
+namespace gcheck {
+
+const char BinaryWriter::magic[8] = {'G', 'C', 'H', 'E', 'C', 'K', 'B', '\0'};
+const uint32_t BinaryWriter::version = 12;
+
+BinaryWriter& BinaryWriter::WriteRaw(const void* data, size_t size) {
+    buffer_.append((const char*)data, size);
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::WriteString(std::string_view str) {
+    WriteU32(str.length());
+    return WriteRaw(str.data(), str.length());
+}
+
+BinaryWriter& BinaryWriter::WriteHeader(uint32_t flags) {
+    WriteRaw(magic, sizeof(magic));
+    WriteU32(version);
+    return WriteU32(flags);
+}
+
+template<template<typename> class A>
+std::string BinaryWriter::Encode(const _UserObject<A>& o) {
+    BinaryWriter writer;
+    writer.WriteString(o.json());
+    writer.WriteString(o.string());
+#ifdef GCHECK_CONSTRUCT_DATA
+    writer.WriteBool(true);
+    writer.WriteString(o.construct());
+#else
+    writer.WriteBool(false);
+#endif
+    return writer.str();
+}
+
+template<template<typename> class A>
+BinaryWriter& BinaryWriter::Write(const _UserObject<A>& o) {
+    if(InternTable::table)
+        return WriteU32(InternTable::table->Intern(Encode(o)));
+
+    std::string bytes = Encode(o);
+    return WriteRaw(bytes.data(), bytes.length());
+}
+
+template<template<typename> class A>
+BinaryWriter& BinaryWriter::Write(const _CaseEntry<A>& e) {
+    // bit i is set if the i:th optional field is present
+    const std::optional<_UserObject<A>>* fields[] = { &e.input, &e.output, &e.output_expected, &e.arguments };
+
+    uint8_t mask = 0;
+    for(size_t i = 0; i < std::size(fields); i++)
+        if(*fields[i]) mask |= 1 << i;
+
+    WriteU8(mask);
+    for(auto field : fields)
+        if(*field) Write(**field);
+
+    return WriteBool(e.result);
+}
+
+template<template<typename> class A>
+BinaryWriter& BinaryWriter::Write(const _FunctionEntry<A>& e) {
+    return WriteRun(e);
+}
+
+template<template<typename> class A>
+BinaryWriter& BinaryWriter::Write(const _RunRow<A>& e) {
+    return WriteRun(e);
+}
+
+template<typename E>
+BinaryWriter& BinaryWriter::WriteRun(const E& e) {
+    // bit i is set if the i:th optional object is present
+    auto fields = E::Objects();
+
+    uint16_t mask = 0;
+    for(size_t i = 0; i < fields.size(); i++)
+        if(e.*fields[i]) mask |= 1 << i;
+
+    WriteU16(mask);
+    for(auto field : fields)
+        if(e.*field) Write(*(e.*field));
+
+    WriteBool((bool)e.max_run_time);
+    if(e.max_run_time)
+        WriteI64(e.max_run_time->count());
+    WriteI64(e.run_time.count());
+    WriteBool((bool)e.io_counts);
+    if(e.io_counts) {
+        WriteI64(e.io_counts->read_calls);
+        WriteI64(e.io_counts->write_calls);
+        WriteI64(e.io_counts->read_bytes);
+        WriteI64(e.io_counts->written_bytes);
+    }
+    WriteBool((bool)e.operation_counts);
+    if(e.operation_counts) {
+        WriteI64(e.operation_counts->comparisons);
+        WriteI64(e.operation_counts->dereferences);
+        WriteI64(e.operation_counts->copies);
+        WriteI64(e.operation_counts->moves);
+        WriteI64(e.operation_counts->allocations);
+    }
+    for(auto max : E::Limits()) {
+        WriteBool((bool)(e.*max));
+        if(e.*max)
+            WriteI64(*(e.*max));
+    }
+    WriteBool((bool)e.conditions);
+    if(e.conditions) {
+        WriteU32(e.conditions->cpu);
+        WriteU8(e.conditions->governor);
+        WriteU32(e.conditions->frequency);
+        WriteF64(e.conditions->load);
+        WriteI64(e.conditions->preemptions);
+        WriteBool(e.conditions->pinned);
+        WriteBool(e.conditions->noisy);
+    }
+    WriteBool((bool)e.timer);
+    if(e.timer) {
+        WriteI64(e.timer->overhead.count());
+        WriteI64(e.timer->resolution.count());
+        WriteU32(e.timer->batch);
+    }
+    WriteU8(e.cache_mode);
+    WriteF64(e.timeout.count());
+    WriteU8(e.status);
+    return WriteBool(e.result);
+}
+
+template<template<typename> class A>
+BinaryWriter& BinaryWriter::Write(const _TestReport<A>& r) {
+    WriteU8(r.data.index());
+    WriteString(r.info_stream.str());
+
+    if(const auto d = std::get_if<_EqualsData<A>>(&r.data)) {
+        Write(d->output_expected);
+        Write(d->output);
+        WriteBool(d->result);
+        WriteString(d->descriptor);
+    } else if(const auto d = std::get_if<_TrueData<A>>(&r.data)) {
+        WriteBool(d->value);
+        WriteBool(d->result);
+        WriteString(d->descriptor);
+    } else if(const auto d = std::get_if<_FalseData<A>>(&r.data)) {
+        WriteBool(d->value);
+        WriteBool(d->result);
+        WriteString(d->descriptor);
+    } else if(const auto d = std::get_if<_CaseData<A>>(&r.data)) {
+        WriteU32(d->size());
+        for(auto& e : *d)
+            Write(e);
+    } else if(const auto d = std::get_if<_FunctionData<A>>(&r.data)) {
+        WriteU32(d->Size());
+        d->ForEachRow([this](const _RunRow<A>& row) { Write(row); });
+    } else if(const auto d = std::get_if<_ScaleData<A>>(&r.data)) {
+        WriteU32(d->size());
+        for(auto& e : *d) {
+            WriteU32(e.threads);
+            WriteI64(e.run_time.count());
+            WriteF64(e.throughput);
+            WriteF64(e.speedup);
+            WriteF64(e.efficiency);
+            WriteBool((bool)e.target_speedup);
+            if(e.target_speedup)
+                WriteF64(*e.target_speedup);
+            WriteU8(e.status);
+            WriteBool(e.result);
+        }
+    }
+
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::Write(const Prerequisite& pre) {
+    auto details = pre.GetFullfillmentData();
+
+    WriteBool(pre.IsFulfilled());
+    WriteU32(details.size());
+    for(auto& d : details) {
+        WriteString(std::get<0>(d));
+        WriteString(std::get<1>(d));
+        WriteBool(std::get<2>(d));
+    }
+    return *this;
+}
+
+template<template<typename> class A>
+BinaryWriter& BinaryWriter::Write(const _TestData<A>& data) {
+    WriteU8(data.status);
+    WriteU8(data.grading_method);
+    WriteF64(data.points);
+    WriteF64(data.max_points);
+    WriteI32(data.correct);
+    WriteI32(data.incorrect);
+    WriteString(data.output_format);
+    WriteString(data.sout);
+    WriteString(data.serr);
+    Write(data.prerequisite);
+
+    WriteU32(data.reports.size());
+    for(auto& r : data.reports)
+        Write(r);
+
+    return Write(data.Runs());
+}
+
+BinaryWriter& BinaryWriter::Write(const RunSummary& runs) {
+    WriteU32(runs.runs);
+    WriteU32(runs.passed);
+    WriteU32(runs.timed_out);
+    WriteU32(runs.crashed);
+    WriteI64(runs.total_run_time.count());
+    return WriteI64(runs.max_run_time.count());
+}
+
+std::string_view BinaryReader::ReadString() {
+    uint32_t length = ReadU32();
+    return std::string_view(ReadRaw(length), length);
+}
+
+const char* BinaryReader::ReadRaw(size_t size) {
+    if(size > size_ - pos_)
+        throw std::runtime_error("Binary record ended unexpectedly");
+    const char* ptr = data_ + pos_;
+    pos_ += size;
+    return ptr;
+}
+
+template<template<typename> class A>
+BinaryReader& BinaryReader::Read(_UserObject<A>& o) {
+    JSON json = JSON().Set(std::string(ReadString()));
+    std::string string(ReadString());
+    std::string construct;
+    if(ReadBool())
+        construct = ReadString();
+    o = _UserObject<A>::FromParts(string, json, construct);
+    return *this;
+}
+
+template<template<typename> class A>
+BinaryReader& BinaryReader::Read(_CaseEntry<A>& e) {
+    std::optional<_UserObject<A>>* fields[] = { &e.input, &e.output, &e.output_expected, &e.arguments };
+
+    uint8_t mask = ReadU8();
+    for(size_t i = 0; i < std::size(fields); i++) {
+        if(mask & (1 << i))
+            Read(fields[i]->emplace());
+        else
+            fields[i]->reset();
+    }
+
+    e.result = ReadBool();
+    return *this;
+}
+
+template<template<typename> class A>
+BinaryReader& BinaryReader::Read(_FunctionEntry<A>& e) {
+    auto fields = _FunctionEntry<A>::Objects();
+
+    uint16_t mask = ReadU16();
+    for(size_t i = 0; i < fields.size(); i++) {
+        if(mask & (1 << i))
+            Read((e.*fields[i]).emplace());
+        else
+            (e.*fields[i]).reset();
+    }
+
+    if(ReadBool())
+        e.max_run_time = std::chrono::nanoseconds(ReadI64());
+    else
+        e.max_run_time.reset();
+    e.run_time = std::chrono::nanoseconds(ReadI64());
+    if(ReadBool()) {
+        auto& counts = e.io_counts.emplace();
+        counts.read_calls = ReadI64();
+        counts.write_calls = ReadI64();
+        counts.read_bytes = ReadI64();
+        counts.written_bytes = ReadI64();
+    } else
+        e.io_counts.reset();
+    if(ReadBool()) {
+        auto& counts = e.operation_counts.emplace();
+        counts.comparisons = ReadI64();
+        counts.dereferences = ReadI64();
+        counts.copies = ReadI64();
+        counts.moves = ReadI64();
+        counts.allocations = ReadI64();
+    } else
+        e.operation_counts.reset();
+    for(auto max : _FunctionEntry<A>::Limits()) {
+        if(ReadBool())
+            e.*max = ReadI64();
+        else
+            (e.*max).reset();
+    }
+    if(ReadBool()) {
+        auto& conditions = e.conditions.emplace();
+        conditions.cpu = ReadU32();
+        conditions.governor = TimingConditions::Governor(ReadU8());
+        conditions.frequency = ReadU32();
+        conditions.load = ReadF64();
+        conditions.preemptions = ReadI64();
+        conditions.pinned = ReadBool();
+        conditions.noisy = ReadBool();
+    } else
+        e.conditions.reset();
+    if(ReadBool()) {
+        auto& timer = e.timer.emplace();
+        timer.overhead = std::chrono::nanoseconds(ReadI64());
+        timer.resolution = std::chrono::nanoseconds(ReadI64());
+        timer.batch = ReadU32();
+    } else
+        e.timer.reset();
+    e.cache_mode = CacheMode(ReadU8());
+    e.timeout = std::chrono::duration<double>(ReadF64());
+    e.status = ForkStatus(ReadU8());
+    e.result = ReadBool();
+    return *this;
+}
+
+template<template<typename> class A>
+BinaryReader& BinaryReader::Read(_TestReport<A>& r) {
+    typedef std::basic_string<char, std::char_traits<char>, A<char>> string;
+
+    uint8_t index = ReadU8();
+    r.info_stream.str(std::string(ReadString()));
+
+    switch(index) {
+    case 0: {
+        _EqualsData<A> d;
+        Read(d.output_expected);
+        Read(d.output);
+        d.result = ReadBool();
+        auto descriptor = ReadString();
+        d.descriptor = string(descriptor.begin(), descriptor.end());
+        r.data = d;
+        break;
+    } case 1: {
+        _TrueData<A> d;
+        d.value = ReadBool();
+        d.result = ReadBool();
+        auto descriptor = ReadString();
+        d.descriptor = string(descriptor.begin(), descriptor.end());
+        r.data = d;
+        break;
+    } case 2: {
+        _FalseData<A> d;
+        d.value = ReadBool();
+        d.result = ReadBool();
+        auto descriptor = ReadString();
+        d.descriptor = string(descriptor.begin(), descriptor.end());
+        r.data = d;
+        break;
+    } case 3: {
+        _CaseData<A> d(ReadU32());
+        for(auto& e : d)
+            Read(e);
+        r.data = std::move(d);
+        break;
+    } case 4: {
+        _FunctionData<A> d;
+        for(uint32_t n = ReadU32(); n != 0; n--) {
+            _FunctionEntry<A> e;
+            Read(e);
+            d.Add(e);
+        }
+        r.data = std::move(d);
+        break;
+    } case 5: {
+        _ScaleData<A> d(ReadU32());
+        for(auto& e : d) {
+            e.threads = ReadU32();
+            e.run_time = std::chrono::nanoseconds(ReadI64());
+            e.throughput = ReadF64();
+            e.speedup = ReadF64();
+            e.efficiency = ReadF64();
+            if(ReadBool())
+                e.target_speedup = ReadF64();
+            e.status = ForkStatus(ReadU8());
+            e.result = ReadBool();
+        }
+        r.data = std::move(d);
+        break;
+    } default:
+        throw std::runtime_error("Unknown report type in binary record");
+    }
+
+    return *this;
+}
+
+template<template<typename> class A>
+BinaryReader& BinaryReader::Read(_TestData<A>& data) {
+    typedef std::basic_string<char, std::char_traits<char>, A<char>> string;
+    auto read_string = [this]() {
+        auto str = ReadString();
+        return string(str.begin(), str.end());
+    };
+
+    data.status = TestStatus(ReadU8());
+    data.grading_method = GradingMethod(ReadU8());
+    data.points = ReadF64();
+    data.max_points = ReadF64();
+    data.correct = ReadI32();
+    data.incorrect = ReadI32();
+    data.output_format = ReadString();
+    data.sout = read_string();
+    data.serr = read_string();
+
+    // prerequisite
+    ReadBool();
+    for(uint32_t n = ReadU32(); n != 0; n--) {
+        ReadString();
+        ReadString();
+        ReadBool();
+    }
+
+    data.reports.clear();
+    for(uint32_t n = ReadU32(); n != 0; n--) {
+        data.reports.emplace_back(_TrueData<A>());
+        Read(data.reports.back());
+    }
+
+    // run summary, derived from the reports
+    ReadRaw(4*sizeof(uint32_t) + 2*sizeof(int64_t));
+    return *this;
+}
+
+uint64_t Checksum(const void* data, size_t size) {
+    auto bytes = (const unsigned char*)data;
+    uint64_t hash = 14695981039346656037ull;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+template BinaryWriter& BinaryWriter::Write(const _UserObject<std::allocator>& o);
+template BinaryWriter& BinaryWriter::Write(const _CaseEntry<std::allocator>& e);
+template BinaryWriter& BinaryWriter::Write(const _FunctionEntry<std::allocator>& e);
+template BinaryWriter& BinaryWriter::Write(const _RunRow<std::allocator>& e);
+template BinaryWriter& BinaryWriter::Write(const _TestReport<std::allocator>& r);
+template BinaryWriter& BinaryWriter::Write(const _TestData<std::allocator>& data);
+
+template BinaryWriter& BinaryWriter::Write(const _UserObject<arena_allocator>& o);
+template BinaryWriter& BinaryWriter::Write(const _CaseEntry<arena_allocator>& e);
+template BinaryWriter& BinaryWriter::Write(const _FunctionEntry<arena_allocator>& e);
+template BinaryWriter& BinaryWriter::Write(const _RunRow<arena_allocator>& e);
+template BinaryWriter& BinaryWriter::Write(const _TestReport<arena_allocator>& r);
+template BinaryWriter& BinaryWriter::Write(const _TestData<arena_allocator>& data);
+
+template BinaryReader& BinaryReader::Read(_UserObject<std::allocator>& o);
+template BinaryReader& BinaryReader::Read(_CaseEntry<std::allocator>& e);
+template BinaryReader& BinaryReader::Read(_FunctionEntry<std::allocator>& e);
+template BinaryReader& BinaryReader::Read(_TestReport<std::allocator>& r);
+template BinaryReader& BinaryReader::Read(_TestData<std::allocator>& data);
+
+template BinaryReader& BinaryReader::Read(_UserObject<arena_allocator>& o);
+template BinaryReader& BinaryReader::Read(_CaseEntry<arena_allocator>& e);
+template BinaryReader& BinaryReader::Read(_FunctionEntry<arena_allocator>& e);
+template BinaryReader& BinaryReader::Read(_TestReport<arena_allocator>& r);
+template BinaryReader& BinaryReader::Read(_TestData<arena_allocator>& data);
+
+} // gcheck
@@ -1,16 +1,27 @@
 #include <chrono>
 
 #include "customtest.h"
+#include "machine.h"
 #include "multiprocessing.h"
 
 namespace gcheck {
 
 void CustomTest::ActualTest() {
-    if(do_safe_run_) {
-        auto status = RunForked(std::chrono::duration<double>(timeout_), data_, 1024*1024, std::bind(&CustomTest::TheTest, this));
+    // A recording has to see every Reference call, so it isn't made in a child process
+    bool recording = ReferenceCache::cache && ReferenceCache::cache->GetMode() == ReferenceCache::Record;
+    if(do_safe_run_ && !recording) {
+        std::string stream;
+        auto status = RunForkedStreaming(Machine::ScaleTime(std::chrono::duration<double>(timeout_)), data_, 1024*1024, report_stream_, stream, std::bind(&CustomTest::TheTest, this));
         if(status == OK) {
             data_.status = Finished;
-        } else if(status == TIMEDOUT) {
+            return;
+        }
+
+        // Keep what the test got done before it failed and mark where it happened
+        AddStreamedReports(stream);
+        size_t done = data_.reports.size();
+        ExpectTrue(false, FailureText(status)) << "after " << done << " report" << (done == 1 ? "" : "s");
+        if(status == TIMEDOUT) {
             data_.status = TimedOut;
         }
     } else {
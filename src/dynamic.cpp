@@ -0,0 +1,51 @@
+#include "dynamic.h"
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#endif
+
+namespace gcheck {
+
+Submission* Submission::current = nullptr;
+
+#if defined(__linux__)
+Submission::Submission(const std::string& path) : path_(path) {
+    // RTLD_LOCAL keeps the symbols of different submissions apart
+    handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if(!handle_) {
+        const char* error = dlerror();
+        throw std::runtime_error("Failed to load " + path + ": " + (error ? error : "unknown error"));
+    }
+}
+
+Submission::~Submission() {
+    if(current == this)
+        current = nullptr;
+    if(handle_)
+        dlclose(handle_);
+}
+
+void* Submission::Symbol(const std::string& name) const {
+    return dlsym(handle_, name.c_str());
+}
+#else
+Submission::Submission(const std::string& path) : path_(path) {
+    throw std::runtime_error("Loading submissions is only supported on linux.");
+}
+
+Submission::~Submission() {}
+
+void* Submission::Symbol(const std::string&) const {
+    return nullptr;
+}
+#endif
+
+std::vector<std::string> Submission::Missing() const {
+    std::vector<std::string> missing;
+    for(auto& name : Names())
+        if(!Symbol(name))
+            missing.push_back(name);
+    return missing;
+}
+
+} // gcheck
@@ -0,0 +1,245 @@
+#include "function_test.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "sampler.h"
+
+namespace gcheck {
+
+namespace {
+#if defined(__linux__)
+    // Reads the counters of /proc/thread-self/io, 'length' is the number of bytes the read itself returned
+    bool ReadIOCounts(int fd, IOCounts& counts, size_t& length) {
+        char buffer[256];
+        ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+        if(n <= 0)
+            return false;
+        buffer[n] = '\0';
+        length = n;
+
+        std::pair<const char*, uint64_t*> fields[] = {
+            {"rchar:", &counts.read_bytes}, {"wchar:", &counts.written_bytes},
+            {"syscr:", &counts.read_calls}, {"syscw:", &counts.write_calls}
+        };
+        for(auto& [name, value] : fields) {
+            const char* pos = strstr(buffer, name);
+            if(!pos)
+                return false;
+            *value = strtoull(pos + strlen(name), nullptr, 10);
+        }
+        return true;
+    }
+#endif
+} // anonymous
+
+void FunctionTestBase::ResetTestVars() {
+    check_arguments_ = true;
+}
+
+void FunctionTestBase::StartCall() {
+#if defined(__linux__)
+    if(count_io_) {
+        // Opened for each call, a run may be in a forked process
+        io_fd_ = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+        size_t length;
+        if(io_fd_ >= 0 && ReadIOCounts(io_fd_, io_start_, length)) {
+            // The counters are updated after the read, so it is counted in the next one
+            io_start_.read_calls++;
+            io_start_.read_bytes += length;
+        } else if(io_fd_ >= 0) {
+            close(io_fd_);
+            io_fd_ = -1;
+        }
+    }
+#endif
+    if(exclusive_ || run_max_run_time_)
+        conditions_start_ = Machine::Start();
+    OperationCounter::Start();
+    Sampler::Start();
+    call_start_ = Timer::Now();
+}
+
+void FunctionTestBase::FinishCall(FunctionEntry& data) {
+    auto elapsed = Timer::Now() - call_start_;
+    data.run_time = Timer::Correct(elapsed, batch_, call_overhead_);
+    if(exclusive_ || run_max_run_time_)
+        Machine::Finish(conditions_start_, data.conditions.emplace());
+    if(run_max_run_time_ || exclusive_ || batch_ > 1)
+        data.timer = TimerInfo{Timer::ReadOverhead() + call_overhead_*batch_, (Timer::Resolution() + std::chrono::nanoseconds(batch_ - 1))/batch_, batch_};
+    Sampler::Stop();
+    OperationCounter::Stop();
+    if(count_operations_ || OperationCounter::Used())
+        data.operation_counts = OperationCounter::Counts();
+#if defined(__linux__)
+    if(io_fd_ >= 0) {
+        // Output still in the buffers was produced by the call
+        std::cout.flush();
+        std::cerr.flush();
+        fflush(stdout);
+        fflush(stderr);
+
+        IOCounts end;
+        size_t length;
+        if(ReadIOCounts(io_fd_, end, length)) {
+            data.io_counts = IOCounts{
+                end.read_calls - io_start_.read_calls, end.write_calls - io_start_.write_calls,
+                end.read_bytes - io_start_.read_bytes, end.written_bytes - io_start_.written_bytes
+            };
+        }
+        close(io_fd_);
+        io_fd_ = -1;
+    }
+#endif
+}
+
+void FunctionTestBase::FinishWarmUp(bool tested) {
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(stdout);
+    fflush(stderr);
+    if(tested)
+        for(auto& f : post_warm_up_functions_)
+            f();
+}
+
+void FunctionTestBase::RunOnce(FunctionEntry& data) {
+    TraceSpan span("run", "run");
+    if(Tracer::Enabled())
+        span.SetArgs("{\"index\":" + std::to_string(run_index_) + "}");
+
+    for(auto& f : pre_run_functions_)
+        f(run_index_, data);
+
+    {
+        ProfileScope profile(Profiler::Stringify);
+        CallFunction(data);
+    }
+    Profiler::Transfer(Profiler::Stringify, Profiler::Call, data.run_time*batch_);
+
+    data.cache_mode = cache_mode_;
+    data.max_run_time = run_max_run_time_;
+    if(data.max_run_time)
+        data.result = data.result && data.run_time <= data.max_run_time.value();
+    data.max_read_calls = max_read_calls_;
+    data.max_write_calls = max_write_calls_;
+    if(data.io_counts) {
+        if(max_read_calls_)
+            data.result = data.result && data.io_counts->read_calls <= *max_read_calls_;
+        if(max_write_calls_)
+            data.result = data.result && data.io_counts->write_calls <= *max_write_calls_;
+    }
+    data.max_comparisons = max_comparisons_;
+    data.max_allocations = max_allocations_;
+    if(data.operation_counts) {
+        if(max_comparisons_)
+            data.result = data.result && data.operation_counts->comparisons <= *max_comparisons_;
+        if(max_allocations_)
+            data.result = data.result && data.operation_counts->allocations <= *max_allocations_;
+    }
+
+    for(auto& f : post_run_functions_)
+        f(run_index_, data);
+}
+
+void FunctionTestBase::SetRunLimits() {
+    run_timeout_ = Machine::ScaleTime(timeout_);
+    run_max_run_time_ = max_run_time_ ? std::optional(Machine::ScaleTime(*max_run_time_)) : std::nullopt;
+    if(relative_multiplier_ <= 0)
+        return;
+
+    auto reference = ReferenceTime();
+    if(!reference)
+        return;
+    run_max_run_time_ = std::chrono::duration_cast<std::chrono::nanoseconds>(*reference * relative_multiplier_);
+    run_timeout_ = std::max<std::chrono::duration<double>>(*run_max_run_time_, min_relative_timeout_);
+}
+
+void FunctionTestBase::ActualTest() {
+    TestReport report = TestReport::Make<FunctionData>();
+    auto& runs = report.Get<FunctionData>();
+    runs.Resize(num_runs_); // each run is stored by its index once it's done
+    // Here so that forked runs don't each calibrate
+    Timer::Calibrate();
+    CalibrateCall();
+
+#if defined(__linux__)
+    std::map<size_t, FunctionEntry> running; // the parallel runs until their results are read back
+    std::optional<ForkPool> pool; // created on the first parallel run, SetParallelRuns is usually called from the test body
+#endif
+
+    for(run_index_ = 0; run_index_ < size_t(num_runs_); run_index_++) {
+        {
+            ProfileScope profile(Profiler::Setup);
+
+            ResetTestVars();
+
+            for(auto& f : reset_vars_functions_)
+                f();
+
+            SetInputsAndOutputs();
+#if defined(__linux__)
+            // The reference is timed alone, not next to the busy workers
+            if(pool && relative_multiplier_ > 0)
+                pool->Wait();
+#endif
+            SetRunLimits(); // from the values set by the test body
+        }
+
+        if(parallel_runs_ > 1 && !exclusive_) {
+#if defined(__linux__)
+            if(!pool)
+                pool.emplace(parallel_runs_);
+            KeepLastArguments(); // as RunOnce would have done here
+            size_t index = run_index_;
+            FunctionEntry& entry = running[index];
+            entry.timeout = run_timeout_;
+            pool->Run(run_timeout_, entry, [this, &entry]() {
+                for(auto& f : child_init_functions_)
+                    f();
+                RunOnce(entry);
+            }, [&runs, &running, &entry, index](ForkStatus status) {
+                entry.status = status;
+                entry.result = status == OK && entry.result;
+                runs.Set(index, entry);
+                running.erase(index);
+            });
+            continue;
+#else
+            throw std::runtime_error("Parallel runs are only supported on linux.");
+#endif
+        }
+
+        FunctionEntry entry;
+        if(do_safe_run_) {
+#if defined(__linux__)
+            entry.status = gcheck::RunForked(run_timeout_, entry, 1024*1024, std::bind(&FunctionTestBase::RunOnce, this, std::placeholders::_1), entry);
+            entry.result = entry.result && entry.status == OK;
+            if(entry.status == OK)
+                Profiler::Transfer(Profiler::Fork, Profiler::Call, entry.run_time*batch_);
+#else
+            throw std::runtime_error("Safe running is only supported on linux.");
+#endif
+        } else {
+            RunOnce(entry);
+        }
+        entry.timeout = run_timeout_;
+        runs.Set(run_index_, entry);
+    }
+#if defined(__linux__)
+    if(pool)
+        pool->Wait();
+#endif
+
+    AddReport(report);
+    data_.status = Finished;
+}
+
+} // gcheck
@@ -4,11 +4,26 @@
 #include <fstream>
 #include <algorithm>
 #include <map>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <iomanip>
+#if !defined(_WIN32) && !defined(WIN32)
+    #include <unistd.h>
+#endif
+#if defined(__linux__)
+    #include <sys/wait.h>
+#endif
 
 #include "argument.h"
 #include "redirectors.h"
 #include "console_writer.h"
 #include "shared_allocator.h"
+#include "binary.h"
+#include "intern_table.h"
+#include "profiler.h"
+#include "sampler.h"
+#include "machine.h"
 
 namespace gcheck {
 // TODO: For some reason linker gives undefined reference errors without this.
@@ -19,28 +34,47 @@ namespace {
         Static class for keeping track of and logging test results.
     */
     class Formatter {
-        typedef std::map<std::string, const TestData*> TestMap;
+        typedef _TestData<arena_allocator> Data;
+        typedef std::map<std::string, const Data*> TestMap;
         typedef std::map<std::string, JSON> TestMapJSON;
+        typedef std::map<std::string, std::string> TestMapBinary;
 
         static std::map<std::string, TestMap> suites_;
         static std::map<std::string, TestMapJSON> suites_json_;
+        static std::map<std::string, TestMapBinary> suites_binary_;
 
         static double total_points_;
         static double total_max_points_;
 
+        // Rendered values shared by all the tests of the report
+        static InternTable intern_table_;
+
         static std::string default_format_;
 
         Formatter() {}; //Disallows instantiation of this class
 
-        static void UpdateTestJSON(const std::string& suite, const std::string& test);
+        static void UpdateTestReport(const std::string& suite, const std::string& test);
+        static void SaveReport();
         static void SaveJSON();
+        static void SaveBinary();
+        static JSON ProfileJSON(const Profiler::Times& times);
+        static std::string ProfileLine(const Profiler::Times& times);
+        static void WriteProfile();
     public:
+        enum ReportFormat {
+            JSONFormat,
+            BinaryFormat
+        };
+
         static bool pretty_;
         static bool json_;
+        static bool intern_;
+        static ReportFormat report_format_;
         static bool do_confirm_;
         static std::string filename_;
 
-        static void AddTest(const std::string& suite, const std::string& test, const TestData& data);
+        static void SetReportFormat(const std::string& format);
+        static void AddTest(const std::string& suite, const std::string& test, const Data& data);
         static void StartTest(const std::string& suite, const std::string& test);
         static void FinishTest(const std::string& suite, const std::string& test);
         static void Finish();
@@ -50,28 +84,78 @@ namespace {
     double Formatter::total_max_points_ = 0;
     bool Formatter::pretty_ = true;
     bool Formatter::json_ = false;
+    bool Formatter::intern_ = false;
+    InternTable Formatter::intern_table_;
+    Formatter::ReportFormat Formatter::report_format_ = Formatter::JSONFormat;
     bool Formatter::do_confirm_ = true;
     std::string Formatter::filename_ = "report.json";
     std::string Formatter::default_format_ = "horizontal";
     std::map<std::string, Formatter::TestMap> Formatter::suites_;
     std::map<std::string, Formatter::TestMapJSON> Formatter::suites_json_;
+    std::map<std::string, Formatter::TestMapBinary> Formatter::suites_binary_;
+
+#ifndef GCHECK_NOMAIN // only main sets the format
+    void Formatter::SetReportFormat(const std::string& format) {
+        if(format == "json")
+            report_format_ = JSONFormat;
+        else if(format == "bin")
+            report_format_ = BinaryFormat;
+        else
+            throw std::runtime_error("Report format not recognized: " + format);
+    }
+#endif
+
+    void Formatter::UpdateTestReport(const std::string& suite, const std::string& test) {
+        ProfileScope profile(Profiler::Report);
+
+        InternTable::table = intern_ ? &intern_table_ : nullptr;
+        if(intern_)
+            intern_table_.Render(suite + '.' + test);
+
+        if(report_format_ == BinaryFormat)
+            suites_binary_[suite][test] = BinaryWriter().Write(*suites_[suite][test]).str();
+        else
+            suites_json_[suite][test] = JSON(*suites_[suite][test]);
 
-    void Formatter::UpdateTestJSON(const std::string& suite, const std::string& test) {
-        suites_json_[suite][test] = JSON(*suites_[suite][test]);
+        InternTable::table = nullptr;
     }
 
-    void Formatter::AddTest(const std::string& suite, const std::string& test, const TestData& data) {
+    void Formatter::AddTest(const std::string& suite, const std::string& test, const Data& data) {
         suites_[suite][test] = &data;
-        UpdateTestJSON(suite, test);
+        UpdateTestReport(suite, test);
 
         total_max_points_ += data.max_points;
     }
 
+    void Formatter::SaveReport() {
+        ProfileScope profile(Profiler::Report);
+
+        if(report_format_ == BinaryFormat)
+            SaveBinary();
+        else
+            SaveJSON();
+    }
+
     void Formatter::SaveJSON() {
         std::vector<std::pair<std::string, JSON>> output;
         output.push_back({"test_results", suites_json_});
         output.push_back({"points", JSON(total_points_)});
         output.push_back({"max_points", JSON(total_max_points_)});
+        output.push_back({"time_scale", JSON(Machine::TimeScale())});
+        if(intern_) {
+            auto& entries = intern_table_.Entries();
+            output.push_back({"interned", JSON().Set(Stringify(entries, [](const auto& e) { return "\"" + std::to_string(e.first) + "\":" + e.second.encoded; }, "{", ",", "}"))});
+        }
+        if(Profiler::Enabled()) {
+            std::map<std::string, std::map<std::string, JSON>> tests;
+            for(auto& [suite, suite_tests] : Profiler::Tests())
+                for(auto& [test, times] : suite_tests)
+                    tests[suite][test] = ProfileJSON(times);
+            output.push_back({"harness_profile", JSON(std::vector<std::pair<std::string, JSON>>{
+                {"total", ProfileJSON(Profiler::Total())},
+                {"tests", JSON(tests)}
+            })});
+        }
 
         std::fstream file(filename_, std::ios_base::out);
 
@@ -80,8 +164,106 @@ namespace {
         file.close();
     }
 
+    void Formatter::SaveBinary() {
+        BinaryWriter writer;
+        uint32_t flags = 0;
+        if(intern_) flags |= BinaryWriter::Interned;
+        if(Profiler::Enabled()) flags |= BinaryWriter::Profiled;
+        writer.WriteHeader(flags);
+        writer.WriteF64(total_points_);
+        writer.WriteF64(total_max_points_);
+        writer.WriteF64(Machine::TimeScale());
+
+        if(intern_) {
+            writer.WriteU32(intern_table_.Size());
+            for(auto& [id, entry] : intern_table_.Entries()) {
+                writer.WriteU32(id);
+                writer.WriteString(entry.encoded);
+            }
+        }
+
+        writer.WriteU32(suites_binary_.size());
+        for(auto& [suite, tests] : suites_binary_) {
+            writer.WriteString(suite);
+            writer.WriteU32(tests.size());
+            for(auto& [test, data] : tests) {
+                writer.WriteString(test);
+                writer.WriteString(data); // length-prefixed so that readers can skip tests
+            }
+        }
+
+        if(Profiler::Enabled()) {
+            auto write_times = [&writer](const Profiler::Times& times) {
+                writer.WriteU32(times.size());
+                for(size_t i = 0; i < times.size(); i++) {
+                    writer.WriteString(Profiler::Name(Profiler::Phase(i)));
+                    writer.WriteI64(times[i]);
+                }
+            };
+            write_times(Profiler::Total());
+            auto& tests = Profiler::Tests();
+            writer.WriteU32(tests.size());
+            for(auto& [suite, suite_tests] : tests) {
+                writer.WriteString(suite);
+                writer.WriteU32(suite_tests.size());
+                for(auto& [test, times] : suite_tests) {
+                    writer.WriteString(test);
+                    write_times(times);
+                }
+            }
+        }
+
+        std::fstream file(filename_, std::ios_base::out | std::ios_base::binary);
+        file.write(writer.str().data(), writer.str().length());
+        file.close();
+    }
+
+    JSON Formatter::ProfileJSON(const Profiler::Times& times) {
+        std::vector<std::pair<std::string, JSON>> phases;
+        for(size_t i = 0; i < times.size(); i++)
+            phases.push_back({Profiler::Name(Profiler::Phase(i)), JSON(times[i])});
+        return JSON(phases);
+    }
+
+    std::string Formatter::ProfileLine(const Profiler::Times& times) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3);
+        for(size_t i = 0; i < times.size(); i++) {
+            if(times[i] == 0)
+                continue;
+            ss << (ss.tellp() == 0 ? "" : ", ") << Profiler::Name(Profiler::Phase(i)) << " " << times[i]/1e6 << " ms";
+        }
+        return ss.str();
+    }
+
+    void Formatter::WriteProfile() {
+        auto& times = Profiler::Total();
+        int64_t total = std::accumulate(times.begin(), times.end(), int64_t(0));
+
+        ConsoleWriter writer;
+        writer.WriteSeparator();
+        std::cout << "Harness profile:" << std::endl;
+        writer.SetHeaders({"Phase", "Time (ms)", "Share"});
+        std::vector<std::vector<std::string>> cells;
+        for(size_t i = 0; i < times.size(); i++) {
+            std::stringstream ms, share;
+            ms << std::fixed << std::setprecision(3) << times[i]/1e6;
+            share << std::fixed << std::setprecision(1) << (total ? 100.0*times[i]/total : 0) << " %";
+            cells.push_back({Profiler::Name(Profiler::Phase(i)), ms.str(), share.str()});
+        }
+        writer.WriteRows(cells);
+    }
+
     void Formatter::Finish() {
+        if(json_ && Profiler::Enabled())
+            SaveReport(); // the profile of the last test and the total are complete only now
+
         if(pretty_) {
+            ProfileScope profile(Profiler::Console);
+
+            if(Profiler::Enabled())
+                WriteProfile();
+
             ConsoleWriter writer;
             writer.WriteSeparator();
             std::cout << "Total: ";
@@ -89,6 +271,8 @@ namespace {
             std::cout << total_points_ << " / " << total_max_points_;
             writer.SetColor(ConsoleWriter::Black);
             std::cout << std::endl;
+            if(Machine::TimeScale() != 1)
+                std::cout << "Time limits scaled by " << Machine::TimeScale() << " to the speed of this host" << std::endl;
 
             if(do_confirm_) {
                 // Wait for user confirmation
@@ -105,14 +289,17 @@ namespace {
             return;
         }
 
+        Profiler::StartTest();
+
         total_points_ += data_ptr->points;
 
         if(json_) {
-            UpdateTestJSON(suite, test);
-            SaveJSON();
+            UpdateTestReport(suite, test);
+            SaveReport();
         }
 
         if(pretty_) {
+            ProfileScope profile(Profiler::Console);
             ConsoleWriter writer;
             writer.WriteSeparator();
         }
@@ -128,12 +315,15 @@ namespace {
         total_points_ += data_ptr->points;
 
         if(json_) {
-            UpdateTestJSON(suite, test);
-            SaveJSON();
+            UpdateTestReport(suite, test);
+            SaveReport();
         }
 
+        Profiler::FinishTest(suite, test);
+
         if(pretty_) {
-            const TestData& test_data = *data_ptr;
+            ProfileScope profile(Profiler::Console);
+            const Data& test_data = *data_ptr;
 
             ConsoleWriter writer;
 
@@ -141,97 +331,157 @@ namespace {
             std::cout << test_data.points << " / " << test_data.max_points << "  suite: " << suite << ", test: " << test << std::endl;
             writer.SetColor(ConsoleWriter::Black);
 
+            RunSummary runs = test_data.Runs();
+            if(runs.runs > 1) {
+                std::cout << "Runs: " << runs.runs << ", passed: " << runs.passed;
+                if(runs.timed_out) std::cout << ", timed out: " << runs.timed_out;
+                if(runs.crashed) std::cout << ", crashed: " << runs.crashed;
+                std::cout << ", total run time: " << runs.total_run_time.count() << " ns, max: " << runs.max_run_time.count() << " ns" << std::endl;
+            }
+            if(Profiler::Enabled())
+                std::cout << "Harness: " << ProfileLine(Profiler::Tests().at(suite).at(test)) << std::endl;
+
             for(auto it = test_data.reports.begin(); it != test_data.reports.end(); it++) {
                 std::vector<std::vector<std::string>> cells;
-                if(const auto d = std::get_if<EqualsData>(&it->data)) {
+                if(const auto d = std::get_if<_EqualsData<arena_allocator>>(&it->data)) {
                     cells.push_back({});
                     auto& row = cells[cells.size()-1];
                     row.push_back(d->result ? "correct" : "incorrect");
-                    row.push_back(d->descriptor);
+                    row.push_back(std::string(d->descriptor));
                     row.push_back(d->output_expected.string());
                     row.push_back(d->output.string());
                     row.push_back(it->info_stream.str());
 
                     writer.SetHeaders({"Result", "Condition", "Correct", "Output", "Info"});
-                } else if(const auto d = std::get_if<TrueData>(&it->data)) {
+                } else if(const auto d = std::get_if<_TrueData<arena_allocator>>(&it->data)) {
 
                     cells.push_back({});
                     auto& row = cells[cells.size()-1];
                     row.push_back(d->result ? "correct" : "incorrect");
-                    row.push_back(d->descriptor);
+                    row.push_back(std::string(d->descriptor));
                     row.push_back(d->result ? "true" : "false");
                     row.push_back(it->info_stream.str());
 
                     writer.SetHeaders({"Result", "Condition", "Value", "Info"});
-                } else if(const auto d = std::get_if<FalseData>(&it->data)) {
+                } else if(const auto d = std::get_if<_FalseData<arena_allocator>>(&it->data)) {
 
                     cells.push_back({});
                     auto& row = cells[cells.size()-1];
                     row.push_back(d->result ? "correct" : "incorrect");
-                    row.push_back(d->descriptor);
+                    row.push_back(std::string(d->descriptor));
                     row.push_back(d->result ? "true" : "false");
                     row.push_back(it->info_stream.str());
 
                     writer.SetHeaders({"Result", "Condition", "Value", "Info"});
-                } else if(const auto d = std::get_if<CaseData>(&it->data)) {
+                } else if(const auto d = std::get_if<_CaseData<arena_allocator>>(&it->data)) {
 
                     for(auto it2 = d->begin(); it2 != d->end(); it2++) {
                         cells.push_back({});
                         auto& row = cells[cells.size()-1];
-                        auto add_if = [&row](const std::optional<UserObject>& i) {
+                        auto add_if = [&row](const auto& i) {
                             if(i) row.push_back(i->string());
                             else row.push_back("");
                         };
 
-                        add_if(it2->result ? "correct" : "incorrect");
+                        row.push_back(it2->result ? "correct" : "incorrect");
                         add_if(it2->input);
                         add_if(it2->output_expected);
                         add_if(it2->output);
                     }
                     writer.SetHeaders({"Result", "Input", "Correct", "Output"});
-                } else if(const auto d = std::get_if<FunctionData>(&it->data)) {
+                } else if(const auto d = std::get_if<_FunctionData<arena_allocator>>(&it->data)) {
 
                     std::vector<std::string> headers = {"Result"};
                     bool headers_filled = false;
-                    for(auto it2 = d->begin(); it2 != d->end(); it2++) {
+                    for(size_t i = 0; i < d->Size(); i++) {
+                        const auto entry = d->Get(i);
                         cells.push_back({});
                         auto& row = cells[cells.size()-1];
-                        if(it2->status == TIMEDOUT) {
-                            row.push_back("Timed out");
-                            continue;
-                        } else if(it2->status == ERROR) {
-                            row.push_back("Crashed");
+                        if(entry.status != OK) {
+                            row.push_back(FailureText(entry.status));
                             continue;
                         }
-                        row.push_back(it2->result ? "correct" : "incorrect");
+                        row.push_back(entry.result ? "correct" : "incorrect");
                         auto add = [&headers, &row, headers_filled](const std::string& str, const std::string& header) {
                             row.push_back(str);
                             if(!headers_filled) headers.push_back(header);
                         };
-                        auto add_if = [&add, &headers, &row, headers_filled](const std::optional<UserObject>& i, const std::string& header) {
+                        auto add_if = [&add, &headers, &row, headers_filled](const auto& i, const std::string& header) {
                             if(i) add(i->string(), header);
                         };
-                        if(it2->max_run_time) {
-                            add(std::to_string(it2->max_run_time->count()), "Max Run Time");
-                            add(std::to_string(it2->run_time.count()), "Run Time");
+                        if(entry.max_run_time) {
+                            add(std::to_string(entry.max_run_time->count()), "Max Run Time");
+                            std::string run_time = std::to_string(entry.run_time.count());
+                            if(entry.timer) {
+                                run_time += " +- " + std::to_string(entry.timer->resolution.count());
+                                if(entry.timer->batch > 1)
+                                    run_time += " (batch of " + std::to_string(entry.timer->batch) + ")";
+                            }
+                            if(entry.cache_mode != UnchangedCache)
+                                run_time += entry.cache_mode == Cold ? " (cold cache)" : " (warm cache)";
+                            add(run_time, "Run Time");
                         }
-                        add_if(it2->object, "Object");
-                        add_if(it2->object_after, "Object Afterwards");
-                        add_if(it2->object_after_expected, "Correct Object Afterwards");
-                        add_if(it2->arguments, "Arguments");
-                        add_if(it2->return_value, "Return Value");
-                        add_if(it2->return_value_expected, "Correct Return Value");
-                        add_if(it2->input, "Standard Input");
-                        add_if(it2->output, "Standard Output");
-                        add_if(it2->output_expected, "Expected Output");
-                        add_if(it2->error, "Standard Error");
-                        add_if(it2->error_expected, "Expected Error");
-                        add_if(it2->arguments_after, "Arguments Afterwards");
-                        add_if(it2->arguments_after_expected, "Correct Arguments Afterwards");
+                        if(entry.conditions) {
+                            static const char* governors[] = {"unknown", "performance", "powersave", "ondemand", "conservative", "schedutil", "userspace", "other"};
+                            auto& c = *entry.conditions;
+                            char load[16];
+                            snprintf(load, sizeof(load), "%.2f", c.load);
+                            std::string str = "cpu " + std::to_string(c.cpu) + (c.pinned ? " (pinned)" : "")
+                                + ", " + governors[std::min<size_t>(c.governor, std::size(governors) - 1)] + " governor"
+                                + (c.frequency ? " " + std::to_string(c.frequency / 1000) + " MHz" : "")
+                                + ", load " + load + ", " + std::to_string(c.preemptions) + " preemptions";
+                            add(c.noisy ? "noisy: " + str : str, "Conditions");
+                        }
+                        if(entry.io_counts) {
+                            auto limit = [](const std::optional<uint64_t>& max) { return max ? " / " + std::to_string(*max) : std::string(); };
+                            add(std::to_string(entry.io_counts->read_calls) + limit(entry.max_read_calls) + " (" + std::to_string(entry.io_counts->read_bytes) + " B)", "Read Syscalls");
+                            add(std::to_string(entry.io_counts->write_calls) + limit(entry.max_write_calls) + " (" + std::to_string(entry.io_counts->written_bytes) + " B)", "Write Syscalls");
+                        }
+                        if(entry.operation_counts) {
+                            auto& ops = *entry.operation_counts;
+                            auto limit = [](const std::optional<uint64_t>& max) { return max ? " / " + std::to_string(*max) : std::string(); };
+                            add(std::to_string(ops.comparisons) + limit(entry.max_comparisons), "Comparisons");
+                            add(std::to_string(ops.allocations) + limit(entry.max_allocations), "Allocations");
+                            add(std::to_string(ops.dereferences) + " dereferences, " + std::to_string(ops.copies) + " copies, " + std::to_string(ops.moves) + " moves", "Operations");
+                        }
+                        add_if(entry.object, "Object");
+                        add_if(entry.object_after, "Object Afterwards");
+                        add_if(entry.object_after_expected, "Correct Object Afterwards");
+                        add_if(entry.arguments, "Arguments");
+                        add_if(entry.return_value, "Return Value");
+                        add_if(entry.return_value_expected, "Correct Return Value");
+                        add_if(entry.input, "Standard Input");
+                        add_if(entry.output, "Standard Output");
+                        add_if(entry.output_expected, "Expected Output");
+                        add_if(entry.error, "Standard Error");
+                        add_if(entry.error_expected, "Expected Error");
+                        add_if(entry.arguments_after, "Arguments Afterwards");
+                        add_if(entry.arguments_after_expected, "Correct Arguments Afterwards");
 
                         headers_filled = true;
                     }
                     writer.SetHeaders(headers);
+                } else if(const auto d = std::get_if<_ScaleData<arena_allocator>>(&it->data)) {
+
+                    auto fixed = [](double value) {
+                        char buffer[32];
+                        snprintf(buffer, sizeof(buffer), "%.2f", value);
+                        return std::string(buffer);
+                    };
+                    for(auto it2 = d->begin(); it2 != d->end(); it2++) {
+                        cells.push_back({});
+                        auto& row = cells[cells.size()-1];
+                        row.push_back(it2->status != OK ? FailureText(it2->status) : it2->result ? "correct" : "incorrect");
+                        row.push_back(std::to_string(it2->threads));
+                        row.push_back(std::to_string(it2->run_time.count()));
+                        row.push_back(std::to_string(it2->throughput));
+                        row.push_back(fixed(it2->speedup));
+                        row.push_back(fixed(it2->efficiency));
+                        row.push_back(it2->target_speedup ? fixed(*it2->target_speedup) : "");
+                    }
+                    if(it->info_stream.str().length() != 0)
+                        cells.push_back({it->info_stream.str()});
+                    writer.SetHeaders({"Result", "Threads", "Run Time", "Throughput", "Speedup", "Efficiency", "Target Speedup"});
                 } else {
 
                     cells.push_back({});
@@ -320,20 +570,32 @@ Test::Test(const TestInfo& info) : data_(info.max_points, info.prerequisite), su
 }
 
 void Test::RunTest() {
+    ProfileScope profile(Profiler::TestBody);
+
+    std::optional<ProfileScope> capture(std::in_place, Profiler::Capture);
     StdoutCapturer tout;
     StderrCapturer terr;
+    capture.reset();
 
+    reference_calls_.clear();
+    reference_checked_ = false;
     ActualTest();
+    if(exclusive_) {
+        Machine::Release();
+        exclusive_ = false;
+    }
 
+    capture.emplace(Profiler::Capture);
     tout.Restore();
     terr.Restore();
     data_.sout = tout.str();
     data_.serr = terr.str();
+    capture.reset();
 
     data_.CalculatePoints();
 }
 
-TestReport& Test::AddReport(TestReport& report) {
+_TestReport<arena_allocator>& Test::AddReport(TestReport& report) {
     auto increment_correct = [this](bool b) {
         b ? data_.correct++ : data_.incorrect++;
     };
@@ -348,23 +610,99 @@ TestReport& Test::AddReport(TestReport& report) {
         for(auto it = cases->begin(); it != cases->end(); it++) {
             increment_correct(it->result);
         }
-    } else if(const auto cases = std::get_if<FunctionData>(&report.data)) {
-        for(auto it = cases->begin(); it != cases->end(); it++) {
+    } else if(const auto levels = std::get_if<ScaleData>(&report.data)) {
+        for(auto it = levels->begin(); it != levels->end(); it++) {
             increment_correct(it->result);
         }
+    } else if(const auto runs = std::get_if<FunctionData>(&report.data)) {
+        size_t passed = runs->Passed();
+        data_.correct += passed;
+        data_.incorrect += runs->Size() - passed;
     } else {
         // this should never be run
         throw std::exception();
     }
-    data_.reports.push_back(report);
+    data_.reports.emplace_back(report);
+
+    if(report_stream_ >= 0) {
+        // The info of the previous report is complete only now, so it is sent again
+        if(data_.reports.size() > 1)
+            StreamReport(data_.reports.size()-2);
+        StreamReport(data_.reports.size()-1);
+    }
 
     return data_.reports[data_.reports.size()-1];
 }
 
+void Test::StreamReport(size_t index) {
+    // Keep the output so far in case the process doesn't make it to the end
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(stdout);
+    fflush(stderr);
+
+    BinaryWriter payload;
+    payload.WriteU32(index);
+    payload.Write(data_.reports[index]);
+
+    BinaryWriter frame;
+    frame.WriteU32(payload.str().length());
+    frame.WriteRaw(payload.str().data(), payload.str().length());
+
+    const char* ptr = frame.str().data();
+    size_t left = frame.str().length();
+    while(left != 0) {
+        ssize_t n = write(report_stream_, ptr, left);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            report_stream_ = -1;
+            return;
+        }
+        ptr += n;
+        left -= n;
+    }
+}
+
+void Test::AddStreamedReports(std::string_view stream) {
+    std::vector<std::string_view> payloads;
+    BinaryReader reader(stream.data(), stream.length());
+    while(reader.Remaining() >= sizeof(uint32_t)) {
+        uint32_t length = reader.ReadU32();
+        if(length > reader.Remaining() || length < sizeof(uint32_t))
+            break; // cut off mid-frame
+
+        std::string_view payload(reader.ReadRaw(length), length);
+        uint32_t index;
+        std::memcpy(&index, payload.data(), sizeof(index));
+        if(index > payloads.size())
+            break;
+        if(index == payloads.size())
+            payloads.emplace_back();
+        payloads[index] = payload.substr(sizeof(index));
+    }
+
+    for(auto& payload : payloads) {
+        TestReport report = TestReport::Make<TrueData>();
+        try {
+            BinaryReader(payload.data(), payload.length()).Read(report);
+        } catch(const std::runtime_error&) {
+            break;
+        }
+        AddReport(report);
+    }
+}
+
 void Test::SetGradingMethod(gcheck::GradingMethod method) {
     data_.grading_method = method;
 }
 
+void Test::Exclusive() {
+    if(exclusive_)
+        return;
+    exclusive_ = true;
+    Machine::Acquire();
+}
+
 void Test::OutputFormat(std::string format) {
     data_.output_format = format;
 }
@@ -387,9 +725,19 @@ bool Test::RunTests() {
         for(auto it = test_list.begin(); it != test_list.end(); it++) {
             if((*it)->data_.status == NotStarted && (*it)->data_.prerequisite.IsFulfilled()) {
                 (*it)->data_.status = Started;
+                TraceSpan span((*it)->suite_ + "." + (*it)->test_, "test");
                 Formatter::StartTest((*it)->suite_, (*it)->test_);
-                (*it)->RunTest();
-                Formatter::FinishTest((*it)->suite_, (*it)->test_);
+                Sampler::StartTest((*it)->suite_, (*it)->test_);
+
+                {
+                    arena_manager arena;
+                    arena_scope scope(arena);
+                    (*it)->RunTest();
+                    Sampler::FinishTest();
+                    Formatter::FinishTest((*it)->suite_, (*it)->test_);
+                    // The test has been reported, the results can go in one go with the arena
+                    (*it)->data_.ClearResults();
+                }
                 counter++;
                 finished++;
             }
@@ -401,6 +749,85 @@ bool Test::RunTests() {
     return test_list.size() == finished;
 }
 
+bool Test::RunSubmissions(const std::vector<std::string>& paths) {
+#if defined(__linux__)
+    std::string extension = Formatter::report_format_ == Formatter::BinaryFormat ? ".bin" : ".json";
+    bool all_loaded = true;
+    // The reference values don't depend on the submission, so they are recorded only until one submission has been graded
+    bool recording = ReferenceCache::cache && ReferenceCache::cache->GetMode() == ReferenceCache::Record;
+    bool recorded = false;
+    for(auto& path : paths) {
+        std::cout.flush();
+        std::cerr.flush();
+
+        // The tests are registered once in this process and each submission is graded in a copy of it
+        pid_t pid = fork();
+        if(pid == 0) {
+            try {
+                if(recorded)
+                    ReferenceCache::cache = nullptr;
+                Submission submission(path);
+                auto missing = submission.Missing();
+                if(!missing.empty()) {
+                    std::cerr << path << ": not defined:";
+                    for(auto& name : missing)
+                        std::cerr << ' ' << name;
+                    std::cerr << std::endl;
+                    do_safe_run_ = true; // calling a missing function throws, only the tests using it should fail
+                }
+                Submission::current = &submission;
+
+                size_t dot = path.rfind('.');
+                Formatter::filename_ = (dot == std::string::npos || dot < path.rfind('/') + 1 ? path : path.substr(0, dot)) + extension;
+                if(Sampler::Enabled()) {
+                    // The samples of each submission go to their own files, with the maps including the submission
+                    Sampler::SetPrefix(std::filesystem::path(path).stem().string() + ".");
+                    Sampler::SaveMaps();
+                }
+                RunTests();
+
+                if(ReferenceCache::cache && ReferenceCache::cache->GetMode() == ReferenceCache::Record)
+                    ReferenceCache::cache->Save();
+                else if(ReferenceCache::cache && ReferenceCache::cache->Stale())
+                    std::cerr << path << ": the reference values differ from the recorded ones, the reference cache was not used" << std::endl;
+                else if(ReferenceCache::cache && ReferenceCache::cache->Misses() != 0)
+                    std::cerr << path << ": " << ReferenceCache::cache->Misses() << " reference value(s) were not found and were computed again" << std::endl;
+                std::cout.flush();
+                std::cerr.flush();
+                fflush(NULL);
+                Tracer::Flush();
+                _exit(0);
+            } catch(const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                _exit(2);
+            }
+        }
+
+        int status = 0;
+        if(pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << path << ": no report, " << (pid > 0 && WIFEXITED(status) ? "failed to load" : "crashed") << std::endl;
+            all_loaded = false;
+        } else if(recording)
+            recorded = true;
+    }
+    return all_loaded;
+#else
+    (void)paths;
+    throw std::runtime_error("Loading submissions is only supported on linux.");
+#endif
+}
+
+uint64_t Test::Signature() {
+    std::string names;
+    for(Test* t : test_list_()) {
+        names += t->suite_;
+        names += '\0';
+        names += t->test_;
+        names += '\0';
+    }
+    return Checksum(names.data(), names.length());
+}
+
 Test* Test::FindTest(std::string suite, std::string test) {
     std::vector<Test*>& tests = test_list_();
     for(Test* t : tests)
@@ -417,10 +844,17 @@ int main(int argc, char** argv) {
     using namespace gcheck;
 
     int i = 1;
+    bool filename_given = false;
     auto next_param = [&i, argv]() {
         return argv[i++];
     };
 
+    std::string reference_file;
+    std::optional<ReferenceCache::Mode> reference_mode;
+    std::string submissions;
+    std::string sample_directory;
+    int sample_rate = 997;
+
     Formatter::pretty_ = false;
     while(i < argc) {
         auto param = next_param();
@@ -428,15 +862,71 @@ int main(int argc, char** argv) {
         else if(param == std::string("--pretty")) Formatter::pretty_ = true;
         else if(param == std::string("--no-confirm")) Formatter::do_confirm_ = false;
         else if(param == std::string("--safe")) Test::do_safe_run_ = true;
+        else if(param == std::string("--intern-report")) Formatter::intern_ = true;
+        else if(param == std::string("--profile-harness")) Profiler::Enable();
+        else if(param == std::string("--trace")) Tracer::Enable(next_param());
+        else if(param == std::string("--sample-profile")) sample_directory = next_param();
+        else if(param == std::string("--sample-rate")) sample_rate = std::stoi(next_param());
+        else if(param == std::string("--pin-cpus")) Machine::ReserveCPUs(next_param());
+        else if(param == std::string("--time-scale")) Machine::SetTimeScale(std::stod(next_param()));
+        else if(param == std::string("--machine-score")) {
+            std::cout << Machine::Score(true) << std::endl;
+            return 0;
+        }
         else if(param == std::string("--width")) ConsoleWriter::width_ = std::stoi(next_param());
-        else if(strncmp(param, "--", 2) == 0) throw std::runtime_error(std::string("Argument not recognized: ") + param);
-        else Formatter::filename_ = param;
+        else if(param == std::string("--record-reference")) {
+            reference_file = next_param();
+            reference_mode = ReferenceCache::Record;
+        } else if(param == std::string("--replay-reference")) {
+            reference_file = next_param();
+            reference_mode = ReferenceCache::Replay;
+        } else if(param == std::string("--submissions")) submissions = next_param();
+        else if(strncmp(param, "--report-format=", 16) == 0) {
+            Formatter::SetReportFormat(param + 16);
+            Formatter::json_ = true;
+        } else if(strncmp(param, "--", 2) == 0) throw std::runtime_error(std::string("Argument not recognized: ") + param);
+        else {
+            Formatter::filename_ = param;
+            filename_given = true;
+        }
+    }
+    if(sample_directory != "") Sampler::Enable(sample_directory, sample_rate);
+    Machine::CalibrateTimeScale();
+    if(submissions != "") {
+        Formatter::json_ = true; // every submission gets its own report
+        Formatter::do_confirm_ = false;
     }
     if(!Formatter::pretty_ && !Formatter::json_) Formatter::pretty_ = true;
     if(Formatter::json_ && Formatter::filename_ == "") Formatter::filename_ = "report.json";
+    if(Formatter::report_format_ == Formatter::BinaryFormat && !filename_given) Formatter::filename_ = "report.bin";
 
-    Test::RunTests();
+    std::unique_ptr<ReferenceCache> reference_cache;
+    if(reference_mode) {
+        reference_cache = std::make_unique<ReferenceCache>(reference_file, *reference_mode, Test::Signature());
+        ReferenceCache::cache = reference_cache.get();
+    }
+
+    bool all_loaded = true;
+    if(submissions != "") {
+        std::vector<std::string> paths;
+        for(auto& entry : std::filesystem::directory_iterator(submissions))
+            if(entry.path().extension() == ".so")
+                paths.push_back(entry.path().string());
+        std::sort(paths.begin(), paths.end());
+        all_loaded = Test::RunSubmissions(paths);
+    } else
+        Test::RunTests();
+
+    if(reference_cache) {
+        if(*reference_mode == ReferenceCache::Record && submissions == "")
+            reference_cache->Save();
+        else if(reference_cache->Stale())
+            std::cerr << "Reference cache: the reference values differ from the recorded ones, the cache was not used" << std::endl;
+        else if(reference_cache->Misses() != 0) // counted here only without --submissions
+            std::cerr << "Reference cache: " << reference_cache->Misses() << " value(s) were not found and were computed again" << std::endl;
+        ReferenceCache::cache = nullptr;
+    }
 
-    return 0;
+    return all_loaded ? 0 : 1;
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "intern_table.h"
+
+namespace gcheck {
+
+InternTable* InternTable::table = nullptr;
+
+size_t InternTable::Intern(std::string encoded) {
+    size_t id;
+    if(auto it = ids_.find(encoded); it != ids_.end())
+        id = it->second;
+    else {
+        id = next_id_++;
+        Entry& entry = entries_[id];
+        entry.encoded = std::move(encoded);
+        ids_.emplace(entry.encoded, id);
+    }
+
+    entries_[id].references++;
+    if(current_)
+        current_->push_back(id);
+    return id;
+}
+
+void InternTable::Render(const std::string& key) {
+    current_ = &renders_[key];
+    for(size_t id : *current_) {
+        auto it = entries_.find(id);
+        if(--it->second.references == 0) {
+            ids_.erase(it->second.encoded);
+            entries_.erase(it);
+        }
+    }
+    current_->clear();
+}
+
+void InternTable::Clear() {
+    entries_.clear();
+    ids_.clear();
+    renders_.clear();
+    current_ = nullptr;
+}
+
+} // gcheck
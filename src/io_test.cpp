@@ -0,0 +1,67 @@
+#include "io_test.h"
+
+namespace gcheck {
+
+IOPlugin::IOPlugin(FunctionTestBase* test) : tout_(false), terr_(false), tin_(false) {
+    test->AddResetTest([this](){ this->ResetTestVars(); });
+    test->AddPreRun([this](size_t index, FunctionEntry& entry){ this->PreRun(index, entry); });
+    test->AddPostRun([this](size_t index, FunctionEntry& entry){ this->PostRun(index, entry); });
+    test->AddChildInit([this](){ tout_.Reopen(); terr_.Reopen(); });
+    test->AddPostWarmUp([this](){ this->ResetWarmUp(); });
+}
+
+void IOPlugin::ResetTestVars() {
+    input_.reset();
+    expected_output_.reset();
+    expected_error_.reset();
+    do_close = false;
+}
+
+void IOPlugin::Inject() {
+    if(input_) {
+        tin_.Capture();
+        tin_.Write(*input_);
+        if(do_close) tin_.Close();
+    }
+}
+
+void IOPlugin::PreRun(size_t, FunctionEntry&) {
+    ProfileScope profile(Profiler::Capture);
+
+    Inject();
+
+    tout_.Capture();
+    terr_.Capture();
+}
+
+void IOPlugin::ResetWarmUp() {
+    // Reading the captured output moves past it, the streams have been flushed already
+    tout_.str();
+    terr_.str();
+    if(input_) {
+        tin_.Restore();
+        Inject();
+    }
+}
+
+void IOPlugin::PostRun(size_t, FunctionEntry& entry) {
+    ProfileScope profile(Profiler::Capture);
+
+    tout_.Restore();
+    terr_.Restore();
+    tin_.Restore();
+
+    if(input_) entry.input = *input_;
+
+    std::string outstr = tout_.str();
+    std::string errstr = terr_.str();
+    entry.output = outstr;
+    if(expected_output_)
+        entry.output_expected = *expected_output_;
+    entry.error = errstr;
+    if(expected_error_)
+        entry.error_expected = *expected_error_;
+    entry.result = entry.result && (!expected_output_ || *expected_output_ == outstr) && (!expected_error_ || *expected_error_ == errstr);
+}
+
+} // gcheck
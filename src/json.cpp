@@ -7,9 +7,17 @@
 #include "gcheck.h"
 #include "stringify.h"
 #include "multiprocessing.h"
+#include "intern_table.h"
 
 namespace gcheck {
 
+namespace {
+    template<template<typename> class A>
+    std::string String(const std::basic_string<char, std::char_traits<char>, A<char>>& str) {
+        return std::string(str.begin(), str.end());
+    }
+} // anonymous
+
 _JSON<std::allocator> _JSON<std::allocator>::Escape(std::string str) {
     _JSON json;
     return json.Set(JSONEscape(str));
@@ -17,42 +25,107 @@ _JSON<std::allocator> _JSON<std::allocator>::Escape(std::string str) {
 
 _JSON<std::allocator>::_JSON(const char* str) : _JSON(JSONEscape(str)) {}
 
-_JSON<std::allocator>::_JSON(const _FunctionEntry<std::allocator>& e) {
-    std::vector<_JSON> data;
-    auto add_if = [&data](const std::string& str, auto a) {
-        if(a) data.emplace_back(str, *a);
-    };
-    add_if("input", e.input);
-    add_if("output", e.output);
-    add_if("output_expected", e.output_expected);
-    add_if("error", e.error);
-    add_if("error_expected", e.error_expected);
-    add_if("arguments", e.arguments);
-    add_if("arguments_after", e.arguments_after);
-    add_if("arguments_after_expected", e.arguments_after_expected);
-    add_if("return_value", e.return_value);
-    add_if("return_value_expected", e.return_value_expected);
-    add_if("object", e.object);
-    add_if("object_after", e.object_after);
-    add_if("object_after_expected", e.object_after_expected);
-    data.emplace_back("run_time", e.run_time.count());
-    data.emplace_back("timeout", e.timeout.count());
-    data.emplace_back("status", e.status);
-    data.emplace_back("result", e.result);
+namespace {
+    // The members of a run, from a _FunctionEntry or a _RunRow
+    template<typename E>
+    std::string RunJSON(const E& e) {
+        std::vector<JSON> data;
+        auto add_if = [&data](const std::string& str, auto a) {
+            if(a) data.emplace_back(str, *a);
+        };
+        add_if("input", e.input);
+        add_if("output", e.output);
+        add_if("output_expected", e.output_expected);
+        add_if("error", e.error);
+        add_if("error_expected", e.error_expected);
+        add_if("arguments", e.arguments);
+        add_if("arguments_after", e.arguments_after);
+        add_if("arguments_after_expected", e.arguments_after_expected);
+        add_if("return_value", e.return_value);
+        add_if("return_value_expected", e.return_value_expected);
+        add_if("object", e.object);
+        add_if("object_after", e.object_after);
+        add_if("object_after_expected", e.object_after_expected);
+        data.emplace_back("run_time", e.run_time.count());
+        if(e.max_run_time)
+            data.emplace_back("max_run_time", e.max_run_time->count());
+        if(e.io_counts)
+            data.emplace_back("io", JSON(std::vector{
+                std::pair("read_calls", JSON(e.io_counts->read_calls)),
+                std::pair("write_calls", JSON(e.io_counts->write_calls)),
+                std::pair("read_bytes", JSON(e.io_counts->read_bytes)),
+                std::pair("written_bytes", JSON(e.io_counts->written_bytes)),
+            }));
+        add_if("max_read_calls", e.max_read_calls);
+        add_if("max_write_calls", e.max_write_calls);
+        if(e.operation_counts)
+            data.emplace_back("operations", JSON(std::vector{
+                std::pair("comparisons", JSON(e.operation_counts->comparisons)),
+                std::pair("dereferences", JSON(e.operation_counts->dereferences)),
+                std::pair("copies", JSON(e.operation_counts->copies)),
+                std::pair("moves", JSON(e.operation_counts->moves)),
+                std::pair("allocations", JSON(e.operation_counts->allocations)),
+            }));
+        add_if("max_comparisons", e.max_comparisons);
+        add_if("max_allocations", e.max_allocations);
+        if(e.conditions) {
+            static const char* governors[] = {"unknown", "performance", "powersave", "ondemand", "conservative", "schedutil", "userspace", "other"};
+            data.emplace_back("conditions", JSON(std::vector{
+                std::pair("cpu", JSON(e.conditions->cpu)),
+                std::pair("governor", JSON(governors[std::min<size_t>(e.conditions->governor, std::size(governors) - 1)])),
+                std::pair("frequency", JSON(e.conditions->frequency)),
+                std::pair("load", JSON(e.conditions->load)),
+                std::pair("preemptions", JSON(e.conditions->preemptions)),
+                std::pair("pinned", JSON(e.conditions->pinned)),
+                std::pair("noisy", JSON(e.conditions->noisy)),
+            }));
+        }
+        if(e.timer)
+            data.emplace_back("timer", JSON(std::vector{
+                std::pair("overhead", JSON(e.timer->overhead.count())),
+                std::pair("resolution", JSON(e.timer->resolution.count())),
+                std::pair("batch", JSON(e.timer->batch)),
+            }));
+        if(e.cache_mode != UnchangedCache)
+            data.emplace_back("cache", e.cache_mode == Cold ? "cold" : "warm");
+        data.emplace_back("timeout", e.timeout.count());
+        data.emplace_back("status", e.status);
+        data.emplace_back("result", e.result);
 
-    Set(Stringify(data, [](const _JSON& a) -> std::string { return a; }, "{", ",", "}"));
+        return Stringify(data, [](const JSON& a) -> std::string { return a; }, "{", ",", "}");
+    }
+} // anonymous
+
+template<template<typename> class A>
+_JSON<std::allocator>::_JSON(const _FunctionEntry<A>& e) {
+    Set(RunJSON(e));
 }
 
-_JSON<std::allocator>::_JSON(const _UserObject<std::allocator>& o)
-        : _JSON(std::vector{
+template<template<typename> class A>
+_JSON<std::allocator>::_JSON(const _RunRow<A>& e) {
+    Set(RunJSON(e));
+}
+
+template<template<typename> class A>
+_JSON<std::allocator>::_JSON(const _UserObject<A>& o) {
+    auto encode = [&o]() -> std::string {
+        return _JSON(std::vector{
             std::pair("json", o.json()),
 #ifdef GCHECK_CONSTRUCT_DATA
             std::pair("construct", _JSON(o.construct())),
 #endif
             std::pair("string", _JSON(o.string())),
-        }) {}
+        });
+    };
+
+    if(InternTable::table)
+        Set("{\"interned\":" + std::to_string(InternTable::table->Intern(encode())) + "}");
+    else
+        Set(encode());
+}
 
-_JSON<std::allocator>::_JSON(const _CaseEntry<std::allocator>& e) {
+template<template<typename> class A>
+_JSON<std::allocator>::_JSON(const _CaseEntry<A>& e) {
     std::vector<_JSON> data;
     auto add_if = [&data](const std::string& str, auto a) {
         if(a) data.emplace_back(str, *a);
@@ -66,6 +139,21 @@ _JSON<std::allocator>::_JSON(const _CaseEntry<std::allocator>& e) {
     Set(Stringify(data, [](const _JSON& a) -> std::string { return a; }, "{", ",", "}"));
 }
 
+_JSON<std::allocator>::_JSON(const ScaleEntry& e) {
+    std::vector<_JSON> data;
+    data.emplace_back("threads", e.threads);
+    data.emplace_back("run_time", e.run_time.count());
+    data.emplace_back("throughput", e.throughput);
+    data.emplace_back("speedup", e.speedup);
+    data.emplace_back("efficiency", e.efficiency);
+    if(e.target_speedup)
+        data.emplace_back("target_speedup", *e.target_speedup);
+    data.emplace_back("status", e.status);
+    data.emplace_back("result", e.result);
+
+    Set(Stringify(data, [](const _JSON& a) -> std::string { return a; }, "{", ",", "}"));
+}
+
 _JSON<std::allocator>::_JSON(const ForkStatus& s) {
     switch(s) {
     case OK:
@@ -74,6 +162,9 @@ _JSON<std::allocator>::_JSON(const ForkStatus& s) {
     case TIMEDOUT:
         Set("\"TIMEDOUT\"");
         break;
+    case OVERSIZED:
+        Set("\"OVERSIZED\"");
+        break;
     case ERROR:
     default:
         Set("\"ERROR\"");
@@ -81,36 +172,41 @@ _JSON<std::allocator>::_JSON(const ForkStatus& s) {
     }
 }
 
-_JSON<std::allocator>::_JSON(const _TestReport<std::allocator>& r) {
+template<template<typename> class A>
+_JSON<std::allocator>::_JSON(const _TestReport<A>& r) {
 
     std::string out = "{";
-    if(const auto d = std::get_if<EqualsData>(&r.data)) {
+    if(const auto d = std::get_if<_EqualsData<A>>(&r.data)) {
         out += _JSON("type", "EE") + ',';
 
         out += _JSON("output_expected", d->output_expected.string()) + ',';
         out += _JSON("output", d->output.string()) + ',';
         out += _JSON("result", d->result) + ',';
-        out += _JSON("descriptor", d->descriptor) + ',';
-    } else if(const auto d = std::get_if<TrueData>(&r.data)) {
+        out += _JSON("descriptor", String(d->descriptor)) + ',';
+    } else if(const auto d = std::get_if<_TrueData<A>>(&r.data)) {
         out += _JSON("type", "ET") + ',';
 
         out += _JSON("value", d->value) + ',';
         out += _JSON("result", d->result) + ',';
-        out += _JSON("descriptor", d->descriptor) + ',';
-    } else if(const auto d = std::get_if<FalseData>(&r.data)) {
+        out += _JSON("descriptor", String(d->descriptor)) + ',';
+    } else if(const auto d = std::get_if<_FalseData<A>>(&r.data)) {
         out += _JSON("type", "EF") + ',';
 
         out += _JSON("value", d->value) + ',';
         out += _JSON("result", d->result) + ',';
-        out += _JSON("descriptor", d->descriptor) + ',';
-    } else if(const auto d = std::get_if<CaseData>(&r.data)) {
+        out += _JSON("descriptor", String(d->descriptor)) + ',';
+    } else if(const auto d = std::get_if<_CaseData<A>>(&r.data)) {
         out += _JSON("type", "TC") + ',';
 
         out += _JSON("cases", *d) + ',';
-    } else if(const auto d = std::get_if<FunctionData>(&r.data)) {
+    } else if(const auto d = std::get_if<_FunctionData<A>>(&r.data)) {
         out += _JSON("type", "FC") + ',';
 
         out += _JSON("cases", *d) + ',';
+    } else if(const auto d = std::get_if<_ScaleData<A>>(&r.data)) {
+        out += _JSON("type", "SC") + ',';
+
+        out += _JSON("levels", *d) + ',';
     }
     out += _JSON("info", r.info_stream.str());
     out += "}";
@@ -138,25 +234,51 @@ _JSON<std::allocator>::_JSON(const TestStatus& status) {
     }
 }
 
-_JSON<std::allocator>::_JSON(const _TestData<std::allocator>& data) {
+template<template<typename> class A>
+_JSON<std::allocator>::_JSON(const _TestData<A>& data) {
 
     std::string out = "{";
     out += _JSON("results", data.reports) + ',';
     out += _JSON("grading_method", data.grading_method) + ',';
     out += _JSON("prerequisite", data.prerequisite) + ',';
-    out += _JSON("format", data.output_format) + ',';
+    out += _JSON("format", String(data.output_format)) + ',';
     out += _JSON("points", data.points) + ',';
     out += _JSON("max_points", data.max_points) + ',';
-    out += _JSON("stdout", data.sout) + ',';
-    out += _JSON("stderr", data.serr) + ',';
+    out += _JSON("stdout", String(data.sout)) + ',';
+    out += _JSON("stderr", String(data.serr)) + ',';
     out += _JSON("correct", data.correct) + ',';
     out += _JSON("incorrect", data.incorrect) + ',';
+    RunSummary runs = data.Runs();
+    if(runs.runs != 0)
+        out += _JSON("run_summary", runs) + ',';
     out += _JSON("status", data.status);
     out += "}";
 
     Set(out);
 }
 
+template<template<typename> class A>
+_JSON<std::allocator>::_JSON(const _RunColumns<A>& runs) {
+    std::string out = "[";
+    runs.ForEachRow([&out](const _RunRow<A>& row) {
+        out += (out.length() > 1 ? "," : "") + _JSON(row);
+    });
+    out += "]";
+    Set(out);
+}
+
+_JSON<std::allocator>::_JSON(const RunSummary& runs) {
+    std::string out = "{";
+    out += _JSON("runs", runs.runs) + ',';
+    out += _JSON("passed", runs.passed) + ',';
+    out += _JSON("timed_out", runs.timed_out) + ',';
+    out += _JSON("crashed", runs.crashed) + ',';
+    out += _JSON("total_run_time", runs.total_run_time.count()) + ',';
+    out += _JSON("max_run_time", runs.max_run_time.count());
+    out += "}";
+    Set(out);
+}
+
 _JSON<std::allocator>::_JSON(const Prerequisite& pre) {
     auto v = pre.GetFullfillmentData();
     std::vector<std::tuple<std::pair<std::string, std::string>,std::pair<std::string, std::string>, std::pair<std::string, bool>>> v2(v.size());
@@ -176,6 +298,22 @@ _JSON<std::allocator>::_JSON(const Prerequisite& pre) {
     Set(out);
 }
 
+template _JSON<std::allocator>::_JSON<std::allocator>(const _UserObject<std::allocator>& o);
+template _JSON<std::allocator>::_JSON<std::allocator>(const _CaseEntry<std::allocator>& e);
+template _JSON<std::allocator>::_JSON<std::allocator>(const _FunctionEntry<std::allocator>& e);
+template _JSON<std::allocator>::_JSON<std::allocator>(const _RunRow<std::allocator>& e);
+template _JSON<std::allocator>::_JSON<std::allocator>(const _TestReport<std::allocator>& r);
+template _JSON<std::allocator>::_JSON<std::allocator>(const _RunColumns<std::allocator>& runs);
+template _JSON<std::allocator>::_JSON<std::allocator>(const _TestData<std::allocator>& data);
+
+template _JSON<std::allocator>::_JSON<arena_allocator>(const _UserObject<arena_allocator>& o);
+template _JSON<std::allocator>::_JSON<arena_allocator>(const _CaseEntry<arena_allocator>& e);
+template _JSON<std::allocator>::_JSON<arena_allocator>(const _FunctionEntry<arena_allocator>& e);
+template _JSON<std::allocator>::_JSON<arena_allocator>(const _RunRow<arena_allocator>& e);
+template _JSON<std::allocator>::_JSON<arena_allocator>(const _TestReport<arena_allocator>& r);
+template _JSON<std::allocator>::_JSON<arena_allocator>(const _RunColumns<arena_allocator>& runs);
+template _JSON<std::allocator>::_JSON<arena_allocator>(const _TestData<arena_allocator>& data);
+
 template _JSON<std::allocator>::_JSON(const std::string& key, const int& value);
 template _JSON<std::allocator>::_JSON(const int& v);
 template _JSON<std::allocator>::_JSON(const std::string& key, const unsigned int& value);
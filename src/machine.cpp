@@ -0,0 +1,352 @@
+#include "machine.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <sched.h>
+    #include <sys/file.h>
+    #include <sys/resource.h>
+    #include <sys/sysinfo.h>
+    #include <unistd.h>
+#endif
+
+#include "gcheck.h"
+#include "timer.h"
+
+namespace gcheck {
+
+std::vector<int> Machine::reserved_;
+int Machine::acquired_cpu_ = -1;
+int Machine::lock_fd_ = -1;
+double Machine::reference_score_ = 0;
+double Machine::time_scale_ = 1;
+bool Machine::time_scale_set_ = false;
+
+namespace {
+#if defined(__linux__)
+    cpu_set_t previous_affinity;
+
+    // Reads the first line of a sysfs or procfs file, empty if it can't be read
+    std::string ReadLine(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "r");
+        if(!file)
+            return "";
+        char buffer[128];
+        std::string line = fgets(buffer, sizeof(buffer), file) ? buffer : "";
+        fclose(file);
+        if(!line.empty() && line.back() == '\n')
+            line.pop_back();
+        return line;
+    }
+
+    TimingConditions::Governor ParseGovernor(const std::string& name) {
+        if(name.empty()) return TimingConditions::UnknownGovernor;
+        if(name == "performance") return TimingConditions::Performance;
+        if(name == "powersave") return TimingConditions::Powersave;
+        if(name == "ondemand") return TimingConditions::Ondemand;
+        if(name == "conservative") return TimingConditions::Conservative;
+        if(name == "schedutil") return TimingConditions::Schedutil;
+        if(name == "userspace") return TimingConditions::Userspace;
+        return TimingConditions::OtherGovernor;
+    }
+
+    // Opens the lock of 'name' in the temporary directory, shared by all gcheck processes on the host
+    int OpenLock(const std::string& name) {
+        std::error_code error;
+        auto dir = std::filesystem::temp_directory_path(error);
+        std::string path = (error ? std::filesystem::path("/tmp") : dir) / ("gcheck-" + name + ".lock");
+        return open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    }
+
+    void Pin(int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+#endif
+
+    std::unique_ptr<unsigned char[]> eviction_buffer;
+    size_t eviction_size = 0;
+
+    // Changed whenever the benchmark changes, so that old cached scores aren't used
+    const int benchmark_version = 1;
+
+    std::filesystem::path ScoreCachePath() {
+        std::filesystem::path dir;
+        if(const char* cache = getenv("XDG_CACHE_HOME"); cache && *cache)
+            dir = cache;
+        else if(const char* home = getenv("HOME"); home && *home)
+            dir = std::filesystem::path(home) / ".cache";
+        else {
+            std::error_code error;
+            dir = std::filesystem::temp_directory_path(error);
+        }
+
+        std::string host = "host";
+#if defined(__linux__)
+        char name[256] = {};
+        if(gethostname(name, sizeof(name) - 1) == 0 && name[0])
+            host = name;
+#endif
+        return dir / "gcheck" / ("score-" + std::to_string(benchmark_version) + "-" + host);
+    }
+
+    // Seconds of the fastest of three rounds of 'round'
+    template<typename F>
+    double Fastest(F&& round) {
+        auto best = std::chrono::nanoseconds::max();
+        for(int i = 0; i < 3; i++) {
+            auto start = Timer::Now();
+            round();
+            best = std::min(best, Timer::Now() - start);
+        }
+        return std::chrono::duration<double>(best).count();
+    }
+
+    // Integer and floating point arithmetic, millions of iterations per second
+    double ComputeRate() {
+        const uint32_t iterations = 4000000;
+        volatile uint64_t sink;
+        double seconds = Fastest([&]() {
+            uint64_t x = 88172645463325252ull;
+            double y = 1;
+            for(uint32_t i = 0; i < iterations; i++) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                y = y*0.999999 + double(x & 0xff);
+            }
+            sink = x + uint64_t(y);
+        });
+        (void)sink;
+        return iterations / seconds / 1e6;
+    }
+
+    // Dependent loads from random cache lines of a buffer larger than the caches, millions of loads per second
+    double MemoryRate() {
+        const uint32_t size = 8*1024*1024; // 32 MiB of indices
+        const uint32_t line = 16; // indices per 64 bytes
+        const uint32_t loads = 500000;
+
+        // Sattolo's shuffle of the lines makes a single cycle through all of them
+        std::vector<uint32_t> order(size/line);
+        for(uint32_t i = 0; i < order.size(); i++)
+            order[i] = i*line;
+        uint64_t state = 0x9e3779b97f4a7c15ull;
+        for(uint32_t i = order.size() - 1; i > 0; i--) {
+            state = state*6364136223846793005ull + 1442695040888963407ull;
+            uint32_t j = (state >> 33) % i;
+            uint32_t swapped = order[i];
+            order[i] = order[j];
+            order[j] = swapped;
+        }
+        std::unique_ptr<uint32_t[]> next(new uint32_t[size]());
+        for(uint32_t i = 0; i < order.size(); i++)
+            next[order[i]] = order[(i + 1) % order.size()];
+
+        volatile uint32_t sink;
+        uint32_t index = 0;
+        double seconds = Fastest([&]() {
+            for(uint32_t i = 0; i < loads; i++)
+                index = next[index];
+            sink = index;
+        });
+        (void)sink;
+        return loads / seconds / 1e6;
+    }
+} // anonymous
+
+void Machine::ReserveCPUs(const std::string& cpus) {
+#if defined(__linux__)
+    cpu_set_t allowed;
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        throw std::runtime_error("Could not read the CPU affinity of the process");
+
+    size_t pos = 0;
+    while(pos < cpus.length()) {
+        size_t end = cpus.find(',', pos);
+        if(end == std::string::npos)
+            end = cpus.length();
+        std::string range = cpus.substr(pos, end - pos);
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for(int cpu = first; cpu <= last; cpu++) {
+                if(cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed))
+                    throw std::runtime_error("CPU " + std::to_string(cpu) + " isn't available to the process");
+                reserved_.push_back(cpu);
+            }
+        } catch(const std::invalid_argument&) {
+            throw std::runtime_error("Invalid CPU list: " + cpus);
+        }
+        pos = end + 1;
+    }
+    if(reserved_.empty())
+        throw std::runtime_error("Invalid CPU list: " + cpus);
+
+    // The rest of the harness is kept off the reserved CPUs, unless they are all there is
+    cpu_set_t others = allowed;
+    for(int cpu : reserved_)
+        CPU_CLR(cpu, &others);
+    if(CPU_COUNT(&others) != 0)
+        sched_setaffinity(0, sizeof(others), &others);
+#else
+    (void)cpus;
+    throw std::runtime_error("Pinning CPUs is only supported on linux.");
+#endif
+}
+
+void Machine::Acquire() {
+#if defined(__linux__)
+    if(Acquired())
+        return;
+    sched_getaffinity(0, sizeof(previous_affinity), &previous_affinity);
+
+    int cpu = -1;
+    if(reserved_.empty()) {
+        lock_fd_ = OpenLock("exclusive");
+        if(lock_fd_ >= 0)
+            flock(lock_fd_, LOCK_EX);
+        cpu = sched_getcpu();
+    } else {
+        // Takes the first free reserved CPU, or waits for the first one
+        for(int reserved : reserved_) {
+            int fd = OpenLock("cpu" + std::to_string(reserved));
+            if(fd >= 0 && flock(fd, LOCK_EX | LOCK_NB) == 0) {
+                lock_fd_ = fd;
+                cpu = reserved;
+                break;
+            }
+            if(fd >= 0)
+                close(fd);
+        }
+        if(cpu < 0) {
+            cpu = reserved_[0];
+            lock_fd_ = OpenLock("cpu" + std::to_string(cpu));
+            if(lock_fd_ >= 0)
+                flock(lock_fd_, LOCK_EX);
+        }
+    }
+    if(cpu >= 0)
+        Pin(cpu);
+    acquired_cpu_ = std::max(cpu, 0);
+#endif
+}
+
+void Machine::Release() {
+#if defined(__linux__)
+    if(!Acquired())
+        return;
+    sched_setaffinity(0, sizeof(previous_affinity), &previous_affinity);
+    if(lock_fd_ >= 0)
+        close(lock_fd_); // releases the lock
+    lock_fd_ = -1;
+    acquired_cpu_ = -1;
+#endif
+}
+
+Machine::Snapshot Machine::Start() {
+    Snapshot snapshot;
+#if defined(__linux__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_THREAD, &usage) == 0)
+        snapshot.preemptions = usage.ru_nivcsw;
+#endif
+    return snapshot;
+}
+
+void Machine::Finish(const Snapshot& start, TimingConditions& conditions) {
+#if defined(__linux__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_THREAD, &usage) == 0)
+        conditions.preemptions = usage.ru_nivcsw - start.preemptions;
+
+    conditions.cpu = sched_getcpu();
+    if(conditions.cpu >= 0) {
+        std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(conditions.cpu) + "/cpufreq/";
+        conditions.governor = ParseGovernor(ReadLine(dir + "scaling_governor"));
+        conditions.frequency = strtoul(ReadLine(dir + "scaling_cur_freq").c_str(), nullptr, 10);
+    }
+
+    double load = 0;
+    if(sscanf(ReadLine("/proc/loadavg").c_str(), "%lf", &load) == 1)
+        conditions.load = load / std::max(get_nprocs(), 1);
+    conditions.pinned = Acquired();
+    conditions.noisy = conditions.preemptions != 0 || conditions.load > 1;
+#else
+    (void)start;
+    (void)conditions;
+#endif
+}
+
+size_t Machine::LastLevelCacheSize() {
+    long size = 0;
+#if defined(_SC_LEVEL4_CACHE_SIZE)
+    size = sysconf(_SC_LEVEL4_CACHE_SIZE);
+#endif
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    if(size <= 0)
+        size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    if(size <= 0)
+        size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return size > 0 ? size : 32*1024*1024;
+}
+
+void Machine::EvictCaches(size_t bytes) {
+    if(bytes == 0)
+        bytes = LastLevelCacheSize()*3/2;
+    if(eviction_size != bytes) {
+        eviction_buffer.reset(new unsigned char[bytes]);
+        eviction_size = bytes;
+    }
+
+    // Writing takes the lines in an exclusive state, also out of the caches of other cores, and the
+    // reads make sure the writes aren't dropped. One byte per 64, the smallest common line size
+    volatile unsigned char* buffer = eviction_buffer.get();
+    for(size_t i = 0; i < bytes; i += 64)
+        buffer[i] = (unsigned char)i;
+    unsigned char sum = 0;
+    for(size_t i = 0; i < bytes; i += 64)
+        sum += buffer[i];
+    (void)sum;
+}
+
+double Machine::Score(bool measure) {
+    auto path = ScoreCachePath();
+    if(!measure) {
+        std::ifstream file(path);
+        double score = 0;
+        if(file >> score && score > 0)
+            return score;
+    }
+
+    // The geometric mean, so that doubling either rate counts the same
+    double score = std::sqrt(ComputeRate() * MemoryRate());
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::ofstream(path) << score << std::endl; // without a cache the score is measured every time
+    return score;
+}
+
+void Machine::CalibrateTimeScale() {
+    if(time_scale_set_ || reference_score_ <= 0)
+        return;
+    time_scale_ = reference_score_ / Score();
+}
+
+} // gcheck
@@ -1,5 +1,12 @@
 #include "multiprocessing.h"
 
+#include <algorithm>
+#include <thread>
+
+#if defined(__linux__)
+    #include <poll.h>
+#endif
+
 namespace gcheck {
 
 #if defined(__linux__)
@@ -36,6 +43,150 @@ ForkStatus wait_timeout(pid_t pid, std::chrono::duration<double> time) {
 
     return info.si_status == 0 ? OK : ERROR;
 }
+
+ForkStatus wait_stream(pid_t pid, int fd, std::chrono::duration<double> time, std::string& out) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::nanoseconds>(time);
+
+    char buffer[4096];
+    while(true) {
+        int wait_ms = -1;
+        if(time != time.zero()) {
+            auto remaining = deadline - std::chrono::steady_clock::now();
+            if(remaining <= remaining.zero()) {
+                kill(pid, SIGKILL);
+                waitpid(pid, NULL, 0);
+                return TIMEDOUT;
+            }
+            wait_ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        }
+
+        pollfd p = { fd, POLLIN, 0 };
+        int ready = poll(&p, 1, wait_ms);
+        if(ready < 0 && errno != EINTR)
+            break;
+        if(ready <= 0)
+            continue;
+
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if(n > 0)
+            out.append(buffer, n);
+        else if(n == 0 || errno != EINTR)
+            break; // the child has closed its end, i.e. it has exited
+    }
+
+    // The child may close its end before exiting, so the deadline still applies
+    int status;
+    while(true) {
+        pid_t waited = waitpid(pid, &status, time != time.zero() ? WNOHANG : 0);
+        if(waited == pid)
+            break;
+        if(waited < 0 && errno != EINTR)
+            return ERROR;
+
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if(time != time.zero() && remaining <= remaining.zero()) {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+            return TIMEDOUT;
+        }
+        if(waited == 0)
+            std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(remaining, std::chrono::milliseconds(1)));
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? OK : ERROR;
+}
+
+ForkPool::ForkPool(size_t workers, size_t slot_size)
+        : workers_(std::max<size_t>(workers, 1)), slot_size_(slot_size), capacity_(slot_size - sizeof(SharedRecord)), memory_(workers_*slot_size) {
+    for(size_t i = workers_; i != 0; i--)
+        free_.push_back(i-1);
+}
+
+ForkPool::~ForkPool() {
+    Wait();
+}
+
+void ForkPool::Wait() {
+    ProfileScope profile(Profiler::Fork);
+
+    while(!running_.empty())
+        Reap();
+
+    if(blocked_) {
+        sigprocmask(SIG_SETMASK, &old_mask_, NULL);
+        blocked_ = false;
+    }
+}
+
+void ForkPool::BlockSIGCHLD() {
+    if(blocked_)
+        return;
+
+    // SIGCHLD is waited for with sigtimedwait while there are workers
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, &old_mask_);
+    blocked_ = true;
+}
+
+size_t ForkPool::Acquire() {
+    while(free_.empty())
+        Reap();
+
+    size_t slot = free_.back();
+    free_.pop_back();
+    return slot;
+}
+
+void ForkPool::Reap() {
+    auto finish = [this](size_t index, ForkStatus status) {
+        Worker worker = std::move(running_[index]);
+        running_.erase(running_.begin() + index);
+        free_.push_back(worker.slot);
+        worker.finish(status);
+    };
+
+    while(true) {
+        bool reaped = false;
+        auto now = std::chrono::steady_clock::now();
+        auto next_deadline = std::chrono::steady_clock::time_point::max();
+        for(size_t i = 0; i < running_.size();) {
+            Worker& worker = running_[i];
+            int status;
+            if(waitpid(worker.pid, &status, WNOHANG) == worker.pid) {
+                finish(i, WIFEXITED(status) && WEXITSTATUS(status) == 0 ? OK : ERROR);
+                reaped = true;
+                continue;
+            }
+            if(worker.deadline && *worker.deadline <= now) {
+                kill(worker.pid, SIGKILL);
+                waitpid(worker.pid, NULL, 0);
+                finish(i, TIMEDOUT);
+                reaped = true;
+                continue;
+            }
+            if(worker.deadline)
+                next_deadline = std::min(next_deadline, *worker.deadline);
+            i++;
+        }
+        if(reaped || running_.empty())
+            return;
+
+        // Sleep until a child exits or the next deadline passes
+        auto wait = std::chrono::nanoseconds(std::chrono::milliseconds(100));
+        if(next_deadline != std::chrono::steady_clock::time_point::max())
+            wait = std::min<std::chrono::nanoseconds>(wait, next_deadline - now);
+
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGCHLD);
+        struct timespec timeout;
+        timeout.tv_sec = wait.count() / 1000000000;
+        timeout.tv_nsec = wait.count() % 1000000000;
+        TraceSpan span("wait", "fork");
+        sigtimedwait(&mask, NULL, &timeout);
+    }
+}
 #endif
 
 } // gcheck
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "profiler.h"
+
+namespace gcheck {
+
+bool Profiler::enabled_ = false;
+Profiler::Phase Profiler::current_ = Profiler::Other;
+std::chrono::steady_clock::time_point Profiler::last_;
+Profiler::Times Profiler::times_{};
+Profiler::Times Profiler::test_start_{};
+std::map<std::string, std::map<std::string, Profiler::Times>> Profiler::tests_;
+
+void Profiler::Enable() {
+    enabled_ = true;
+    last_ = std::chrono::steady_clock::now();
+}
+
+const char* Profiler::Name(Phase phase) {
+    switch(phase) {
+        case Other: return "other";
+        case TestBody: return "test";
+        case Setup: return "setup";
+        case Call: return "call";
+        case Stringify: return "stringify";
+        case Capture: return "capture";
+        case Fork: return "fork";
+        case Report: return "report";
+        case Console: return "console";
+        default: return "unknown";
+    }
+}
+
+void Profiler::Transfer(Phase from, Phase to, std::chrono::nanoseconds time) {
+    if(!enabled_)
+        return;
+    times_[from] -= time.count();
+    times_[to] += time.count();
+}
+
+void Profiler::StartTest() {
+    if(enabled_)
+        test_start_ = Total();
+}
+
+void Profiler::FinishTest(const std::string& suite, const std::string& test) {
+    if(!enabled_)
+        return;
+
+    Times times = Total();
+    for(size_t i = 0; i < times.size(); i++)
+        times[i] -= test_start_[i];
+    tests_[suite][test] = times;
+}
+
+const Profiler::Times& Profiler::Total() {
+    if(enabled_)
+        Switch(current_);
+    return times_;
+}
+
+} // gcheck
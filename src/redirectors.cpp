@@ -182,6 +182,25 @@ FileCapturer& FileCapturer::Capture() {
     return *this;
 }
 
+FileCapturer& FileCapturer::Reopen() {
+    bool was_swapped = is_swapped_;
+    Restore();
+
+    FILE* file = tmpfile();
+    if(file == NULL)
+        throw std::runtime_error("errno: " + std::to_string(errno) + ", " + std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": Unable to create a temporary file");
+
+    if(new_ != NULL)
+        fclose(new_);
+    new_ = file;
+    last_pos_ = 0;
+
+    if(was_swapped)
+        Capture();
+
+    return *this;
+}
+
 StdinInjecter::StdinInjecter(std::string str) : FileInjecter(stdin, str, &std::cin) {}
 StdinInjecter::StdinInjecter(const char* str) : StdinInjecter((std::string)str) {}
 StdinInjecter::StdinInjecter(bool capture) : FileInjecter(stdin, capture, &std::cin) {}
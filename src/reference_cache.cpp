@@ -0,0 +1,138 @@
+#include "reference_cache.h"
+
+#include "binary.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if !defined(_WIN32) && !defined(WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace gcheck {
+
+ReferenceCache* ReferenceCache::cache = nullptr;
+
+const char ReferenceCache::magic[8] = {'G', 'C', 'H', 'E', 'C', 'K', 'R', '\0'};
+const uint32_t ReferenceCache::version = 2;
+
+/*
+    File layout:
+    magic, u32 version, u64 test list signature, u64 checksum of the body, u64 body size,
+    body: u32 entry count followed by the entries (key, type name, value)
+*/
+ReferenceCache::ReferenceCache(const std::string& filename, Mode mode, uint64_t signature)
+        : mode_(mode), filename_(filename), signature_(signature) {
+    if(mode_ == Record)
+        return;
+
+    const char* data = nullptr;
+    size_t size = 0;
+#if !defined(_WIN32) && !defined(WIN32)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("Failed to open reference cache: " + filename);
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping != MAP_FAILED) {
+            mapping_ = (const char*)mapping;
+            mapping_size_ = st.st_size;
+        }
+    }
+    close(fd);
+    data = mapping_;
+    size = mapping_size_;
+#endif
+    if(!data) {
+        std::ifstream file(filename, std::ios::binary);
+        if(!file)
+            throw std::runtime_error("Failed to open reference cache: " + filename);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        contents_ = ss.str();
+        data = contents_.data();
+        size = contents_.length();
+    }
+
+    try {
+        BinaryReader reader(data, size);
+        if(std::memcmp(reader.ReadRaw(sizeof(magic)), magic, sizeof(magic)) != 0 || reader.ReadU32() != version)
+            throw std::runtime_error("not a reference cache of this version");
+        if((uint64_t)reader.ReadI64() != signature_)
+            throw std::runtime_error("recorded with a different set of tests");
+        uint64_t checksum = reader.ReadI64();
+        uint64_t body_size = reader.ReadI64();
+        if(body_size != reader.Remaining())
+            throw std::runtime_error("truncated");
+
+        const char* body = reader.ReadRaw(body_size);
+        if(Checksum(body, body_size) != checksum)
+            throw std::runtime_error("checksum mismatch");
+
+        BinaryReader entries(body, body_size);
+        uint32_t count = entries.ReadU32();
+        entries_.reserve(count);
+        for(uint32_t i = 0; i < count; i++) {
+            std::string_view key = entries.ReadString();
+            Entry entry;
+            entry.type = entries.ReadString();
+            entry.value = entries.ReadString();
+            entries_[key] = entry;
+        }
+    } catch(const std::runtime_error& e) {
+#if !defined(_WIN32) && !defined(WIN32)
+        if(mapping_)
+            munmap((void*)mapping_, mapping_size_);
+#endif
+        throw std::runtime_error("Stale or corrupted reference cache " + filename + ": " + e.what());
+    }
+}
+
+ReferenceCache::~ReferenceCache() {
+#if !defined(_WIN32) && !defined(WIN32)
+    if(mapping_)
+        munmap((void*)mapping_, mapping_size_);
+    mapping_ = nullptr;
+#endif
+}
+
+void ReferenceCache::StoreBytes(const std::string& key, std::string_view type, std::string_view value) {
+    BinaryWriter writer;
+    writer.WriteString(key);
+    writer.WriteString(type);
+    writer.WriteString(value);
+    recorded_ += writer.str();
+    count_++;
+}
+
+const ReferenceCache::Entry* ReferenceCache::Find(const std::string& key, std::string_view type) const {
+    auto it = entries_.find(key);
+    if(it == entries_.end() || it->second.type != type)
+        return nullptr;
+    return &it->second;
+}
+
+void ReferenceCache::Save() const {
+    BinaryWriter body;
+    body.WriteU32(count_);
+    body.WriteRaw(recorded_.data(), recorded_.length());
+
+    BinaryWriter header;
+    header.WriteRaw(magic, sizeof(magic));
+    header.WriteU32(version);
+    header.WriteI64(signature_);
+    header.WriteI64(Checksum(body.str().data(), body.str().length()));
+    header.WriteI64(body.str().length());
+
+    std::ofstream file(filename_, std::ios::binary);
+    file << header.str() << body.str();
+    if(!file)
+        throw std::runtime_error("Failed to write reference cache: " + filename_);
+}
+
+} // gcheck
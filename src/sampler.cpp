@@ -0,0 +1,236 @@
+#include "sampler.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/time.h>
+    #include <ucontext.h>
+    #include <unistd.h>
+#endif
+#if defined(GCHECK_LIBUNWIND)
+    #define UNW_LOCAL_ONLY
+    #include <libunwind.h>
+#endif
+
+namespace gcheck {
+
+bool Sampler::enabled_ = false;
+volatile sig_atomic_t Sampler::active_ = 0;
+bool Sampler::timer_running_ = false;
+int Sampler::rate_ = 997;
+int Sampler::maps_pid_ = 0;
+std::string Sampler::directory_;
+std::string Sampler::prefix_;
+std::string Sampler::test_file_;
+
+namespace {
+    const size_t max_depth = 128;
+    const size_t buffer_size = 1 << 20;
+
+    // Samples one after another as [depth, pc, return address, ..., outermost return address].
+    // Preallocated, the signal handler can't allocate
+    uintptr_t* samples = nullptr;
+    volatile size_t used = 0;
+    volatile size_t dropped = 0;
+    uintptr_t stack_high = 0;
+
+#if defined(__linux__)
+    void WriteAll(int fd, const std::string& str) {
+        const char* ptr = str.data();
+        size_t left = str.length();
+        while(left != 0) {
+            ssize_t n = write(fd, ptr, left);
+            if(n < 0) {
+                if(errno == EINTR) continue;
+                return;
+            }
+            ptr += n;
+            left -= n;
+        }
+    }
+#endif
+} // anonymous
+
+void Sampler::Enable(const std::string& directory, int rate) {
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__) || defined(GCHECK_LIBUNWIND))
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if(error)
+        throw std::runtime_error("Could not create directory " + directory + " for the samples");
+    if(rate <= 0 || rate > 1000000)
+        throw std::runtime_error("Invalid sample rate " + std::to_string(rate));
+
+    directory_ = directory;
+    rate_ = rate;
+    samples = new uintptr_t[buffer_size];
+
+    struct sigaction action = {};
+    action.sa_sigaction = &Sampler::OnSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+
+    enabled_ = true;
+    SaveMaps();
+    pthread_atfork(nullptr, nullptr, &Sampler::ClearAfterFork);
+    std::atexit(&Sampler::Flush);
+#else
+    (void)directory;
+    (void)rate;
+    throw std::runtime_error("Sampling is only supported on linux on x86_64 and aarch64.");
+#endif
+}
+
+void Sampler::StartTimer() {
+#if defined(__linux__)
+    // The frames are only followed within the stack of the current thread
+    pthread_attr_t attr;
+    if(pthread_getattr_np(pthread_self(), &attr) == 0) {
+        void* addr;
+        size_t size;
+        pthread_attr_getstack(&attr, &addr, &size);
+        stack_high = (uintptr_t)addr + size;
+        pthread_attr_destroy(&attr);
+    }
+
+    // ITIMER_PROF counts the CPU time of the process, so a process waiting for its children isn't sampled
+    struct itimerval timer = {};
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000/rate_;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    timer_running_ = true;
+#endif
+}
+
+void Sampler::OnSignal(int, siginfo_t*, void* context) {
+#if defined(__linux__)
+    if(!active_)
+        return;
+
+    size_t start = used;
+    if(start + 1 + max_depth > buffer_size) {
+        dropped = dropped + 1;
+        return;
+    }
+    uintptr_t* out = samples + start + 1;
+    size_t depth = 0;
+
+#if defined(GCHECK_LIBUNWIND)
+    // Starts from the interrupted code instead of the handler, needs libunwind 1.3
+    unw_cursor_t cursor;
+    if(unw_init_local2(&cursor, (unw_context_t*)context, UNW_INIT_SIGNAL_FRAME) == 0) {
+        do {
+            unw_word_t ip;
+            unw_get_reg(&cursor, UNW_REG_IP, &ip);
+            out[depth++] = ip;
+        } while(depth < max_depth && unw_step(&cursor) > 0);
+    }
+#else
+    auto uc = (ucontext_t*)context;
+    #if defined(__x86_64__)
+        uintptr_t pc = uc->uc_mcontext.gregs[REG_RIP];
+        uintptr_t fp = uc->uc_mcontext.gregs[REG_RBP];
+        uintptr_t sp = uc->uc_mcontext.gregs[REG_RSP];
+    #elif defined(__aarch64__)
+        uintptr_t pc = uc->uc_mcontext.pc;
+        uintptr_t fp = uc->uc_mcontext.regs[29];
+        uintptr_t sp = uc->uc_mcontext.sp;
+    #endif
+    out[depth++] = pc;
+    // Each frame starts with the previous frame pointer and the return address. Code compiled
+    // without frame pointers leaves anything in the register, so the frames are checked to be on the stack
+    while(depth < max_depth && fp >= sp && fp + 2*sizeof(uintptr_t) <= stack_high && fp % sizeof(uintptr_t) == 0) {
+        uintptr_t* frame = (uintptr_t*)fp;
+        if(frame[1] == 0)
+            break;
+        out[depth++] = frame[1];
+        if(frame[0] <= fp)
+            break;
+        fp = frame[0];
+    }
+#endif
+
+    samples[start] = depth;
+    used = start + 1 + depth;
+#else
+    (void)context;
+#endif
+}
+
+void Sampler::ClearAfterFork() {
+    // The samples recorded so far belong to the parent, and timers aren't inherited
+    used = 0;
+    dropped = 0;
+    timer_running_ = false;
+}
+
+void Sampler::StartTest(const std::string& suite, const std::string& test) {
+    if(!enabled_)
+        return;
+    test_file_ = directory_ + "/" + prefix_ + suite + "." + test + ".stacks";
+}
+
+void Sampler::FinishTest() {
+    if(!enabled_)
+        return;
+    Flush();
+    test_file_.clear();
+}
+
+void Sampler::SaveMaps() {
+#if defined(__linux__)
+    if(!enabled_)
+        return;
+    maps_pid_ = getpid();
+    std::ifstream in("/proc/self/maps");
+    std::ofstream out(directory_ + "/maps." + std::to_string(maps_pid_));
+    out << in.rdbuf();
+#endif
+}
+
+void Sampler::Flush() {
+#if defined(__linux__)
+    if(!enabled_ || test_file_.empty() || (used == 0 && dropped == 0))
+        return;
+
+    // Identical stacks are written once with a count, the outermost frame first
+    std::map<std::vector<uintptr_t>, size_t> stacks;
+    for(size_t pos = 0; pos < used; pos += 1 + samples[pos]) {
+        std::vector<uintptr_t> stack(samples + pos + 1, samples + pos + 1 + samples[pos]);
+        stacks[std::vector<uintptr_t>(stack.rbegin(), stack.rend())]++;
+    }
+
+    std::string out = "# maps " + std::to_string(maps_pid_) + "\n";
+    if(dropped != 0)
+        out += "# dropped " + std::to_string(dropped) + "\n";
+    char buffer[24];
+    for(auto& [stack, count] : stacks) {
+        for(size_t i = 0; i < stack.size(); i++) {
+            snprintf(buffer, sizeof(buffer), i == 0 ? "%zx" : ";%zx", (size_t)stack[i]);
+            out += buffer;
+        }
+        out += " " + std::to_string(count) + "\n";
+    }
+    used = 0;
+    dropped = 0;
+
+    // Forked processes append to the same file, O_APPEND keeps the writes whole
+    int fd = open(test_file_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(fd < 0)
+        return;
+    WriteAll(fd, out);
+    close(fd);
+#endif
+}
+
+} // gcheck
@@ -0,0 +1,200 @@
+#include "scale_test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include "machine.h"
+#include "multiprocessing.h"
+
+namespace gcheck {
+
+namespace {
+    // The CPUs this process may run on, in order
+    std::vector<int> AllowedCPUs() {
+        std::vector<int> cpus;
+#if defined(__linux__)
+        cpu_set_t set;
+        if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for(int i = 0; i < CPU_SETSIZE; i++)
+                if(CPU_ISSET(i, &set))
+                    cpus.push_back(i);
+        }
+#endif
+        if(cpus.empty()) {
+            for(unsigned int i = 0; i < std::max(std::thread::hardware_concurrency(), 1u); i++)
+                cpus.push_back(i);
+        }
+        return cpus;
+    }
+
+#if defined(__linux__)
+    void PinTo(pthread_t thread, const std::vector<int>& cpus, size_t count) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(size_t i = 0; i < count && i < cpus.size(); i++)
+            CPU_SET(cpus[i], &set);
+        pthread_setaffinity_np(thread, sizeof(set), &set);
+    }
+#endif
+} // anonymous
+
+std::chrono::nanoseconds ScaleTest::RunLevel(size_t threads, const std::vector<int>& cpus) {
+    if(pass_threads_) {
+        // The function starts its own threads, they inherit the affinity of this one
+#if defined(__linux__)
+        cpu_set_t previous;
+        bool restore = pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) == 0;
+        PinTo(pthread_self(), cpus, threads);
+#endif
+        auto start = std::chrono::high_resolution_clock::now();
+        std::exception_ptr error;
+        try {
+            function_(threads);
+        } catch(...) {
+            error = std::current_exception();
+        }
+        auto time = std::chrono::high_resolution_clock::now() - start;
+#if defined(__linux__)
+        if(restore)
+            pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+#endif
+        if(error)
+            std::rethrow_exception(error);
+        return time;
+    }
+
+    // Thread i runs on CPU i, wrapping around if there are more threads than CPUs.
+    // The threads wait until all of them have been started so that the startup isn't timed
+    std::atomic<size_t> ready = 0;
+    std::atomic<bool> go = false;
+    std::exception_ptr error;
+    std::atomic_flag error_set = ATOMIC_FLAG_INIT;
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for(size_t i = 0; i < threads; i++) {
+        workers.emplace_back([&]() {
+            ready++;
+            while(!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            try {
+                for(size_t call = 0; call < calls_per_thread_; call++)
+                    function_(threads);
+            } catch(...) {
+                if(!error_set.test_and_set())
+                    error = std::current_exception();
+            }
+        });
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[i % cpus.size()], &set);
+        pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set);
+#endif
+    }
+    while(ready.load() != threads)
+        std::this_thread::yield();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& worker : workers)
+        worker.join();
+    auto time = std::chrono::high_resolution_clock::now() - start;
+
+    if(error)
+        std::rethrow_exception(error);
+    return time;
+}
+
+void ScaleTest::Measure() {
+    TestReport report = TestReport::Make<ScaleData>();
+    auto& data = report.Get<ScaleData>();
+
+    auto cpus = AllowedCPUs();
+    std::vector<size_t> levels = threads_;
+    if(levels.empty()) {
+        size_t max = max_threads_.value_or(cpus.size());
+        for(size_t threads = 1; threads <= max; threads *= 2)
+            levels.push_back(threads);
+        if(levels.back() != max)
+            levels.push_back(max);
+    }
+
+    try {
+        // Warms up the caches and whatever the function initializes on the first call.
+        // An exception is thrown again by the measured runs and reported there
+        RunLevel(levels[0], cpus);
+    } catch(...) {}
+
+    std::stringstream info;
+
+    for(size_t threads : levels) {
+        ScaleEntry entry;
+        entry.threads = threads;
+        entry.run_time = std::chrono::nanoseconds(0);
+        if(auto it = target_speedups_.find(threads); it != target_speedups_.end())
+            entry.target_speedup = it->second;
+        else if(target_efficiency_)
+            entry.target_speedup = *target_efficiency_ * threads;
+
+        try {
+            auto best = std::chrono::nanoseconds::max();
+            for(size_t i = 0; i < std::max<size_t>(repeats_, 1); i++)
+                best = std::min(best, RunLevel(threads, cpus));
+            entry.run_time = best;
+        } catch(const std::exception& e) {
+            info << (info.tellp() ? "\n" : "") << threads << " threads: " << e.what();
+            entry.status = ERROR;
+        } catch(...) {
+            info << (info.tellp() ? "\n" : "") << threads << " threads: unknown exception";
+            entry.status = ERROR;
+        }
+
+        double seconds = std::max(std::chrono::duration<double>(entry.run_time).count(), 1e-9);
+        double units = pass_threads_ ? work_ : work_ * threads * calls_per_thread_;
+        entry.throughput = entry.status == OK ? units / seconds : 0;
+        data.push_back(entry);
+    }
+
+    // Speedups are relative to the first level, assuming it scales perfectly if it has more than one thread
+    const auto& base = data.front();
+    for(auto& entry : data) {
+        entry.speedup = base.throughput != 0 ? entry.throughput / base.throughput * base.threads : 0;
+        entry.efficiency = entry.speedup / entry.threads;
+        entry.result = entry.status == OK && (!entry.target_speedup || entry.speedup >= *entry.target_speedup);
+    }
+
+    AddReport(report).info_stream << info.str();
+}
+
+void ScaleTest::ActualTest() {
+    SetUp();
+
+    if(do_safe_run_) {
+#if defined(__linux__)
+        auto status = RunForked(Machine::ScaleTime(std::chrono::duration<double>(timeout_)), data_, 1024*1024, std::bind(&ScaleTest::Measure, this));
+        if(status != OK) {
+            TestReport report = TestReport::Make<TrueData>();
+            auto& data = report.Get<TrueData>();
+            data.value = false;
+            data.descriptor = FailureText(status);
+            data.result = false;
+            AddReport(report);
+            data_.status = status == TIMEDOUT ? TimedOut : Finished;
+            return;
+        }
+#else
+        throw std::runtime_error("Safe running is only supported on linux.");
+#endif
+    } else {
+        Measure();
+    }
+    data_.status = Finished;
+}
+
+} // gcheck
@@ -1,8 +1,10 @@
 #include <string>
 #include <stack>
 #include <cstring>
-#include <sstream>
+#include <cmath>
 #include <array>
+#include <charconv>
+#include <cstdio>
 
 #include "stringify.h"
 #include "user_object.h"
@@ -27,6 +29,53 @@ std::string Replacee(unsigned char val) {
     return replacees[val];
 }
 
+namespace {
+    /*
+        Formats numbers with std::to_chars into a stack buffer. Unlike std::to_string and streams
+        this is locale independent and doesn't allocate for the intermediate representation.
+        Floating point values are written in the shortest form that round-trips.
+    */
+    template<typename T, typename... Format>
+    std::string ToChars(const T& item, Format... format) {
+        std::array<char, 128> buffer;
+        auto [end, err] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), item, format...);
+        (void)err; // the buffer fits any arithmetic value
+        return std::string(buffer.data(), end);
+    }
+
+    /*
+        Same output as std::to_string (printf's %f): six decimals. Values that the six decimals
+        don't represent exactly, e.g. 1e-7, are written in the shortest form that round-trips
+        instead so that differing values never print the same.
+    */
+    template<typename T>
+    std::string FloatToString(const T& item) {
+        std::array<char, 128> buffer;
+        auto [end, err] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), item, std::chars_format::fixed, 6);
+        if(err != std::errc())
+            return std::to_string(item); // too long for the buffer, and exact at that magnitude
+
+        T parsed;
+        auto [ptr, perr] = std::from_chars(buffer.data(), end, parsed);
+        if(!std::isfinite(item) || (perr == std::errc() && parsed == item))
+            return std::string(buffer.data(), end);
+
+        return ToChars(item);
+    }
+
+    // Exact hexadecimal representation of 'item', same as streaming it with std::hexfloat
+    std::string HexFloat(const double& item) {
+        std::array<char, 64> buffer;
+        int len = std::snprintf(buffer.data(), buffer.size(), "%a", item);
+        return std::string(buffer.data(), len);
+    }
+    std::string HexFloat(const long double& item) {
+        std::array<char, 64> buffer;
+        int len = std::snprintf(buffer.data(), buffer.size(), "%La", item);
+        return std::string(buffer.data(), len);
+    }
+} // anonymous
+
 std::string JSONEscape(std::string str) {
     // find non-utf-8 characters
     for(size_t pos = 0; pos < str.length(); pos++) {
@@ -100,8 +149,8 @@ std::string toConstruct(const char*& item) { return (const char*)item; }
 std::string toConstruct(const std::string& item) {
     return "std::string(" + toConstruct((const char*)item.c_str()) + ")";
 }
-std::string toConstruct(const unsigned char& item) { return "static_cast<unsigned char>(" + std::to_string((int)item) + ")"; }
-std::string toConstruct(const char& item) { return "static_cast<char>(" + std::to_string((int)item) + ")"; }
+std::string toConstruct(const unsigned char& item) { return "static_cast<unsigned char>(" + ToChars((int)item) + ")"; }
+std::string toConstruct(const char& item) { return "static_cast<char>(" + ToChars((int)item) + ")"; }
 std::string toConstruct(const bool& b) { return b ? "true" : "false"; }
 #ifdef GCHECK_CONSTRUCT_DATA
 std::string toConstruct(const UserObject& u) { return u.construct(); }
@@ -109,48 +158,33 @@ std::string toConstruct(const UserObject& u) { return u.construct(); }
 std::string toConstruct(const UserObject&) { return ""; }
 #endif
 std::string toConstruct(decltype(nullptr)) { return "nullptr"; }
-std::string toConstruct(const int& item) { return std::to_string(item); }
-std::string toConstruct(const long& item) { return std::to_string(item) + 'L'; }
-std::string toConstruct(const long long& item) { return std::to_string(item) + "LL"; }
-std::string toConstruct(const unsigned& item) { return std::to_string(item) + 'U'; }
-std::string toConstruct(const unsigned long& item) { return std::to_string(item) + "UL"; }
-std::string toConstruct(const unsigned long long& item) { return std::to_string(item) + "ULL"; }
-
-std::string toConstruct(const float& item) {
-    std::stringstream ss;
-    ss << std::hexfloat << item << 'f';
-    return ss.str();
-}
-
-std::string toConstruct(const double& item) {
-    std::stringstream ss;
-    ss << std::hexfloat << item;
-    return ss.str();
-}
-
-std::string toConstruct(const long double& item) {
-    std::stringstream ss;
-    ss << std::hexfloat << item << 'l';
-    return ss.str();
-}
+std::string toConstruct(const int& item) { return ToChars(item); }
+std::string toConstruct(const long& item) { return ToChars(item) + 'L'; }
+std::string toConstruct(const long long& item) { return ToChars(item) + "LL"; }
+std::string toConstruct(const unsigned& item) { return ToChars(item) + 'U'; }
+std::string toConstruct(const unsigned long& item) { return ToChars(item) + "UL"; }
+std::string toConstruct(const unsigned long long& item) { return ToChars(item) + "ULL"; }
+std::string toConstruct(const float& item) { return HexFloat(double(item)) + 'f'; }
+std::string toConstruct(const double& item) { return HexFloat(item); }
+std::string toConstruct(const long double& item) { return HexFloat(item) + 'l'; }
 
 
 std::string toString(const std::string& item) { return '"' + item + '"'; }
 std::string toString(const char* const&item) { return toString(std::string(item)); }
 std::string toString(const char*& item) { return toString((const char*)item); }
 std::string toString(const char& item) { return std::string("'") + item + "'"; }
-std::string toString(const unsigned char& item) { return std::to_string(item); }
+std::string toString(const unsigned char& item) { return ToChars((unsigned)item); }
 std::string toString(const bool& b) { return b ? "true" : "false"; }
 std::string toString(const UserObject& u) { return u.string(); }
 std::string toString(decltype(nullptr)) { return "nullptr"; }
-std::string toString(const int& item) { return std::to_string(item); }
-std::string toString(const long& item) { return std::to_string(item); }
-std::string toString(const long long& item) { return std::to_string(item); }
-std::string toString(const unsigned& item) { return std::to_string(item); }
-std::string toString(const unsigned long& item) { return std::to_string(item); }
-std::string toString(const unsigned long long& item) { return std::to_string(item); }
-std::string toString(const float& item) { return std::to_string(item); }
-std::string toString(const double& item) { return std::to_string(item); }
-std::string toString(const long double& item) { return std::to_string(item); }
+std::string toString(const int& item) { return ToChars(item); }
+std::string toString(const long& item) { return ToChars(item); }
+std::string toString(const long long& item) { return ToChars(item); }
+std::string toString(const unsigned& item) { return ToChars(item); }
+std::string toString(const unsigned long& item) { return ToChars(item); }
+std::string toString(const unsigned long long& item) { return ToChars(item); }
+std::string toString(const float& item) { return FloatToString(item); }
+std::string toString(const double& item) { return FloatToString(item); }
+std::string toString(const long double& item) { return FloatToString(item); }
 
 } // gcheck
\ No newline at end of file
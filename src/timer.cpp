@@ -0,0 +1,39 @@
+#include "timer.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace gcheck {
+
+bool Timer::calibrated_ = false;
+std::chrono::nanoseconds Timer::read_overhead_(0);
+std::chrono::nanoseconds Timer::resolution_(0);
+
+void Timer::Calibrate() {
+    if(calibrated_)
+        return;
+    calibrated_ = true;
+
+    // The minimums don't include interruptions, so nothing more than the overhead is ever subtracted
+    const size_t samples = 1000;
+    std::vector<std::chrono::nanoseconds> reads(samples);
+    for(auto& read : reads) {
+        auto start = Now();
+        read = Now() - start;
+    }
+    std::sort(reads.begin(), reads.end());
+    read_overhead_ = reads.front();
+
+    // A coarse clock shows up as differences of zero and of the tick, and a noisy one as a spread of the readings
+    auto tick = std::upper_bound(reads.begin(), reads.end(), std::chrono::nanoseconds(0));
+    auto spread = reads[samples*9/10] - reads.front();
+    resolution_ = std::max(tick == reads.end() ? std::chrono::nanoseconds(1) : *tick, spread);
+}
+
+std::chrono::nanoseconds Timer::Correct(std::chrono::nanoseconds elapsed, uint32_t calls, std::chrono::nanoseconds call_overhead) {
+    calls = std::max<uint32_t>(calls, 1);
+    auto time = (elapsed - read_overhead_) / calls - call_overhead;
+    return std::max(time, std::chrono::nanoseconds(0));
+}
+
+} // gcheck
@@ -0,0 +1,165 @@
+#include "trace.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#include "stringify.h"
+
+namespace gcheck {
+
+bool Tracer::enabled_ = false;
+int Tracer::fd_ = -1;
+int Tracer::root_pid_ = 0;
+
+namespace {
+    std::mutex buffers_mutex;
+    std::vector<void*> buffers; // Tracer::Buffer*, never freed so that they outlive the threads at exit
+
+    int64_t Nanoseconds(Tracer::TimePoint time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    // Chrome expects microseconds
+    void AppendMicroseconds(std::string& out, int64_t ns) {
+        char buffer[32];
+        auto end = std::to_chars(buffer, buffer + sizeof(buffer), ns/1000).ptr;
+        int frac = std::abs(ns%1000);
+        *end++ = '.';
+        *end++ = '0' + frac/100;
+        *end++ = '0' + frac/10%10;
+        *end++ = '0' + frac%10;
+        out.append(buffer, end);
+    }
+
+#if defined(__linux__)
+    void WriteAll(int fd, const std::string& str) {
+        const char* ptr = str.data();
+        size_t left = str.length();
+        while(left != 0) {
+            ssize_t n = write(fd, ptr, left);
+            if(n < 0) {
+                if(errno == EINTR) continue;
+                return;
+            }
+            ptr += n;
+            left -= n;
+        }
+    }
+#endif
+} // anonymous
+
+void Tracer::Enable(const std::string& filename) {
+#if defined(__linux__)
+    // Every process appends its events, the root process closes the array last
+    fd_ = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if(fd_ < 0)
+        throw std::runtime_error("Could not open trace file " + filename);
+    WriteAll(fd_, "[\n");
+
+    root_pid_ = getpid();
+    enabled_ = true;
+    pthread_atfork(nullptr, nullptr, &Tracer::ClearAfterFork);
+    std::atexit(&Tracer::Flush);
+#else
+    (void)filename;
+    throw std::runtime_error("Tracing is only supported on linux.");
+#endif
+}
+
+Tracer::Buffer& Tracer::LocalBuffer() {
+    thread_local Buffer* buffer = nullptr;
+    if(!buffer) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffer = new Buffer();
+        buffer->events.reserve(4096);
+        buffer->thread = buffers.size() + 1;
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Tracer::ClearAfterFork() {
+    // The events recorded so far belong to the parent
+    for(auto b : buffers) {
+        ((Buffer*)b)->events.clear();
+        ((Buffer*)b)->strings.clear();
+    }
+}
+
+void Tracer::Complete(const char* name, const char* category, TimePoint start, std::string args) {
+    int64_t begin = Nanoseconds(start);
+    auto& buffer = LocalBuffer();
+    buffer.events.push_back({name, category, begin, Nanoseconds(Now()) - begin, -1, args.empty() ? -1 : buffer.Store(std::move(args)), 'X'});
+}
+
+void Tracer::Complete(std::string name, const char* category, TimePoint start, std::string args) {
+    int64_t begin = Nanoseconds(start);
+    auto& buffer = LocalBuffer();
+    buffer.events.push_back({nullptr, category, begin, Nanoseconds(Now()) - begin, buffer.Store(std::move(name)), args.empty() ? -1 : buffer.Store(std::move(args)), 'X'});
+}
+
+void Tracer::Instant(const char* name, const char* category, std::string args) {
+    auto& buffer = LocalBuffer();
+    buffer.events.push_back({name, category, Nanoseconds(Now()), 0, -1, args.empty() ? -1 : buffer.Store(std::move(args)), 'i'});
+}
+
+void Tracer::Flush() {
+#if defined(__linux__)
+    if(!enabled_)
+        return;
+
+    int pid = getpid();
+    bool root = pid == root_pid_;
+
+    std::string out;
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for(auto b : buffers) {
+        auto& buffer = *(Buffer*)b;
+        std::string ids = ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(buffer.thread);
+        out.reserve(out.size() + buffer.events.size()*128);
+        for(auto& e : buffer.events) {
+            out += "{\"name\":\"";
+            if(e.name)
+                out += e.name;
+            else
+                out += JSONEscape(buffer.strings[e.dynamic_name]);
+            out += "\",\"cat\":\"";
+            out += e.category;
+            out += e.phase == 'X' ? "\",\"ph\":\"X\",\"ts\":" : "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+            AppendMicroseconds(out, e.start);
+            if(e.phase == 'X') {
+                out += ",\"dur\":";
+                AppendMicroseconds(out, e.duration);
+            }
+            out += ids;
+            if(e.args >= 0) {
+                out += ",\"args\":";
+                out += buffer.strings[e.args];
+            }
+            out += "},\n";
+        }
+        buffer.events.clear();
+        buffer.strings.clear();
+    }
+
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"args\":{\"name\":\"" + (root ? "gcheck" : "worker " + std::to_string(pid)) + "\"}}";
+    out += root ? "\n]\n" : ",\n";
+    WriteAll(fd_, out);
+
+    if(root) {
+        close(fd_);
+        enabled_ = false;
+    }
+#endif
+}
+
+} // gcheck
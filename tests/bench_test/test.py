@@ -0,0 +1,38 @@
+#!/usr/bin/env python3
+
+import json
+import os
+import subprocess
+
+# every benchmark once, as briefly as possible
+process = subprocess.run(["../../bench/build/bench", "--min-time", "0", "--repetitions", "1"], stdout=subprocess.PIPE, text=True, check=True)
+results = [json.loads(line) for line in process.stdout.splitlines()]
+
+names = [result["benchmark"] for result in results]
+for name in ["run_forked/round_trip", "json_escape/4k", "json/test_data_1000_runs", "run_tests/1000_tests"]:
+    if name not in names:
+        raise Exception("Benchmark not run: " + name)
+for result in results:
+    if result["ops"] < 1 or result["repetitions"] != 1 or result["ns_per_op"] <= 0 or result["min_ns_per_op"] > result["ns_per_op"]:
+        raise Exception("Invalid result: " + str(result))
+if "mb_per_s" not in results[names.index("json_escape/4k")]:
+    raise Exception("Throughput not reported")
+
+# the filter selects by substring
+process = subprocess.run(["../../bench/build/bench", "json", "--min-time", "0", "--repetitions", "1"], stdout=subprocess.PIPE, text=True, check=True)
+filtered = [json.loads(line)["benchmark"] for line in process.stdout.splitlines()]
+if filtered != [name for name in names if "json" in name]:
+    raise Exception("Wrong benchmarks selected: " + str(filtered))
+
+# a small generated suite through the end-to-end benchmark, built with the flags of the tests
+process = subprocess.run(["python3", "../../bench/scale.py", "--cxxflags", "-O0 " + os.environ.get("CPPFLAGS", ""),
+        "--suites", "2", "--tests", "10", "--total-runs", "200", "--chain", "3", "--io-runs", "2", "--io-size", "256", "--safe-divisor", "10"],
+        stdout=subprocess.PIPE, text=True, check=True)
+modes = {result["mode"]: result for result in (json.loads(line) for line in process.stdout.splitlines() if line.startswith("{"))}
+if sorted(modes) != ["default", "safe"]:
+    raise Exception("Wrong modes: " + str(sorted(modes)))
+if modes["default"]["tests"] != 20 or modes["safe"]["runs"] >= modes["default"]["runs"]:
+    raise Exception("Wrong suite size: " + str(modes))
+for result in modes.values():
+    if result["wall_s"] <= 0 or result["peak_rss_kb"] <= 0 or result["report_bytes"] <= 0:
+        raise Exception("Invalid result: " + str(result))
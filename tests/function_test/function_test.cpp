@@ -1,5 +1,15 @@
 #include <gcheck/gcheck.h>
 #include <gcheck/function_test.h>
+#include <gcheck/method_test.h>
+
+#include <cstdlib>
+#include <chrono>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
 
 void VoidAndEmpty() {
 
@@ -58,4 +68,137 @@ FUNCTIONTEST(values, VoidAndIntInt2_fail, 3, VoidAndIntInt2, 4) {
 FUNCTIONTEST(values, IntAndIntInt2_fail, 3, IntAndIntInt2, 4) {
     SetArguments(2, (int)GetRunIndex());
     SetReturn(GetRunIndex());
-}
\ No newline at end of file
+}
+
+int ParallelDouble(int i) {
+    if(i == 2)
+        std::quick_exit(1);
+    return 2*i;
+}
+std::string ParallelLarge(int length) {
+    return std::string(length, 'x');
+}
+
+FUNCTIONTEST(parallel, ParallelDouble, 6, ParallelDouble, 6) {
+    SetParallelRuns(3);
+    SetArguments((int)GetRunIndex());
+    SetReturn(2*(int)GetRunIndex());
+}
+FUNCTIONTEST(parallel, ParallelLarge, 2, ParallelLarge, 2) {
+    SetParallelRuns(2);
+    // the second result doesn't fit in the worker's slot
+    int length = GetRunIndex() == 0 ? 10 : 2*1024*1024;
+    SetArguments(length);
+    SetReturn(std::string(length, 'x'));
+}
+
+
+struct Counter {
+    int value;
+    int Add(int n) {
+        value += n;
+        return value;
+    }
+    bool operator==(const Counter& other) const { return value == other.value; }
+};
+std::string to_string(const Counter& counter) {
+    return "Counter(" + std::to_string(counter.value) + ")";
+}
+
+METHODTEST(method, Add, 3, &Counter::Add, 3) {
+    int start = GetRunIndex();
+    SetObject(new Counter{start}, true);
+    SetArguments(2);
+    SetReturn(start + 2);
+    SetObjectAfter(new Counter{start + 2}, true);
+}
+METHODTEST(method, Add_fail, 2, &Counter::Add, 2) {
+    SetObject(new Counter{0}, true);
+    SetArguments(2);
+    SetReturn(2);
+    SetObjectAfter(new Counter{0}, true); // the object changes
+}
+
+
+// Busy for long enough to be sampled
+void Spin() {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    while(std::chrono::steady_clock::now() < end) {}
+}
+
+FUNCTIONTEST(profile, Spin, 2, Spin) {
+
+}
+
+
+int null_fd = open("/dev/null", O_WRONLY);
+void WriteUnbuffered(int lines) {
+    for(int i = 0; i < lines; i++)
+        (void)!write(null_fd, "line\n", 5);
+}
+void WriteBuffered(int lines) {
+    std::string buffer;
+    for(int i = 0; i < lines; i++)
+        buffer += "line\n";
+    (void)!write(null_fd, buffer.data(), buffer.length());
+}
+
+FUNCTIONTEST(io, WriteUnbuffered, 2, WriteUnbuffered) {
+    SetArguments(10);
+    SetMaxWriteSyscalls(3);
+}
+FUNCTIONTEST(io, WriteBuffered, 2, WriteBuffered) {
+    SetArguments(10);
+    SetMaxWriteSyscalls(3);
+}
+
+
+typedef gcheck::CountingContainer<std::vector<int>> CountingVector;
+void StdSort(CountingVector& values) {
+    std::sort(values.begin(), values.end());
+}
+void InsertionSort(CountingVector& values) {
+    for(size_t i = 1; i < values.size(); i++)
+        for(size_t j = i; j > 0 && values[j] < values[j-1]; j--)
+            std::swap(values[j], values[j-1]);
+}
+CountingVector Append(int n) {
+    CountingVector values;
+    for(int i = 0; i < n; i++)
+        values.push_back(i);
+    return values;
+}
+CountingVector AppendReserved(int n) {
+    CountingVector values;
+    values.reserve(n);
+    for(int i = 0; i < n; i++)
+        values.push_back(i);
+    return values;
+}
+
+// 200 elements in reverse order, sorted with at most 3*n*log2(n) comparisons
+#define SORT_TEST_BODY \
+    std::vector<int> values(200); \
+    for(size_t i = 0; i < values.size(); i++) \
+        values[i] = values.size() - i; \
+    SetArguments(CountingVector(values.begin(), values.end())); \
+    std::sort(values.begin(), values.end()); \
+    SetArgumentsAfter(CountingVector(values.begin(), values.end())); \
+    SetMaxComparisons(gcheck::NLogN(values.size(), 3));
+
+FUNCTIONTEST(counting, StdSort, 2, StdSort) {
+    SORT_TEST_BODY
+}
+FUNCTIONTEST(counting, InsertionSort, 2, InsertionSort) {
+    SORT_TEST_BODY
+}
+FUNCTIONTEST(counting, Append, 2, Append) {
+    SetArguments(100);
+    SetReturn(AppendReserved(100));
+    SetMaxAllocations(1);
+}
+FUNCTIONTEST(counting, AppendReserved, 2, AppendReserved) {
+    SetArguments(100);
+    SetReturn(AppendReserved(100));
+    SetMaxAllocations(1);
+}
@@ -2,11 +2,14 @@
 
 import sys
 import os
+import json
+import tempfile
+import subprocess
 sys.path.insert(1, os.path.join(sys.path[0], '..'))
 sys.path.insert(1, os.path.join(sys.path[0], '../../tools'))
 
 from utils import run, compare
-from report_parser import Report, Type
+from report_parser import Report, Type, BinaryReader
 
 process = run("function_test")
 report = Report("report.json")
@@ -84,6 +87,199 @@ expect = {
             "num_cases": 3,
         }],
     },
+    "parallel.ParallelDouble": {
+        "max_points": 6,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 6,
+            "statuses": ["OK", "OK", "ERROR", "OK", "OK", "OK"],
+        }],
+    },
+    "parallel.ParallelLarge": {
+        "max_points": 2,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+            "statuses": ["OK", "OVERSIZED"],
+        }],
+    },
+    "profile.Spin": {
+        "points": 1,
+        "max_points": 1,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
+    "io.WriteUnbuffered": {
+        "points": 0,
+        "max_points": 1,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
+    "io.WriteBuffered": {
+        "points": 1,
+        "max_points": 1,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
+    "counting.StdSort": {
+        "points": 1,
+        "max_points": 1,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
+    "counting.InsertionSort": {
+        "points": 0,
+        "max_points": 1,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
+    "counting.Append": {
+        "points": 0,
+        "max_points": 1,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
+    "counting.AppendReserved": {
+        "points": 1,
+        "max_points": 1,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
+    "method.Add": {
+        "points": 3,
+        "max_points": 3,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 3,
+        }],
+    },
+    "method.Add_fail": {
+        "points": 0,
+        "max_points": 2,
+        "results": [{
+            "type": Type.FC,
+            "num_cases": 2,
+        }],
+    },
 }
 
 compare(report, expect)
+
+# the write calls of each run are counted
+for name, calls, bytes in [("WriteUnbuffered", 10, 50), ("WriteBuffered", 1, 50)]:
+    for case in next(test for test in report.tests if test.suite == "io" and test.test == name).results[0].cases:
+        if case.io.write_calls != calls or case.io.written_bytes < bytes or case.max_write_calls != 3:
+            raise Exception(f"Wrong IO counts for {name}: {case.io.write_calls} calls, {case.io.written_bytes} bytes")
+
+# the objects are shown with their to_string
+case = next(test for test in report.tests if test.suite == "method" and test.test == "Add").results[0].cases[1]
+if case.object.string != "Counter(1)" or case.object_after.string != "Counter(3)":
+    raise Exception("Wrong objects: " + case.object.string + ", " + case.object_after.string)
+
+# the operations on the counting types are reported and limited
+for name, comparisons, allocations in [("StdSort", None, 0), ("InsertionSort", 199*200//2, 0), ("Append", 0, None), ("AppendReserved", 0, 1)]:
+    for case in next(test for test in report.tests if test.suite == "counting" and test.test == name).results[0].cases:
+        ops = case.operations
+        if (comparisons is not None and ops.comparisons != comparisons) or (allocations is not None and ops.allocations != allocations):
+            raise Exception(f"Wrong operation counts for {name}: {ops.comparisons} comparisons, {ops.allocations} allocations")
+        if case.result != (ops.comparisons <= (case.max_comparisons or ops.comparisons) and ops.allocations <= (case.max_allocations or ops.allocations)):
+            raise Exception(f"Limits not applied for {name}")
+
+# the values are inline by default
+with open("report.json") as f:
+    if "interned" in json.load(f):
+        raise Exception("Values interned without --intern-report")
+
+process = run("function_test", "--intern-report")
+report = Report("report.json")
+
+compare(report, expect)
+
+# the table has exactly the values that the tests refer to
+def references(value):
+    if isinstance(value, dict):
+        if list(value) == ["interned"]:
+            yield str(value["interned"])
+        else:
+            for item in value.values():
+                yield from references(item)
+    elif isinstance(value, list):
+        for item in value:
+            yield from references(item)
+
+with open("report.json") as f:
+    data = json.load(f)
+referred = set(references(data["test_results"]))
+if not referred or referred != set(data["interned"]):
+    raise Exception("Interned values differ from the referred ones")
+
+for args in [[], ["--intern-report"]]:
+    process = run("function_test", "--report-format=bin", *args)
+    report = Report("report.bin")
+
+    compare(report, expect)
+
+if report.harness_profile is not None:
+    raise Exception("Harness profiled without --profile-harness")
+
+# the phases of the harness are timed for each test and in total
+phases = ["other", "test", "setup", "call", "stringify", "capture", "fork", "report", "console"]
+for args, filename in [([], "report.json"), (["--report-format=bin"], "report.bin")]:
+    process = run("function_test", "--profile-harness", *args)
+    report = Report(filename)
+
+    compare(report, expect)
+    profile = report.harness_profile
+    if sorted(profile["total"]) != sorted(phases):
+        raise Exception("Wrong phases: " + str(profile["total"]))
+    if {f"{suite}.{test}" for suite, tests in profile["tests"].items() for test in tests} != set(expect):
+        raise Exception("Tests missing from the profile")
+    for tests in profile["tests"].values():
+        for times in tests.values():
+            if any(times[phase] < 0 or times[phase] > profile["total"][phase] for phase in phases):
+                raise Exception("Invalid phase times: " + str(times))
+    if profile["total"]["call"] <= 0 or profile["total"]["fork"] <= 0: # the parallel runs fork
+        raise Exception("Calls or forks not timed: " + str(profile["total"]))
+
+# the timeline has a span for every test and the events of the forked workers
+with tempfile.TemporaryDirectory() as directory:
+    trace_file = os.path.join(directory, "trace.json")
+    process = run("function_test", "--trace", trace_file)
+    with open(trace_file) as f:
+        events = json.load(f)
+
+spans = {event["name"] for event in events if event.get("cat") == "test" and event["ph"] == "X"}
+if spans != set(expect):
+    raise Exception("Test spans differ: " + str(spans))
+if any(event["ph"] == "X" and event["dur"] < 0 for event in events):
+    raise Exception("Negative span")
+if len({event["pid"] for event in events if event.get("cat") == "run"}) < 2:
+    raise Exception("Runs of the workers missing")
+instants = {event["name"] for event in events if event.get("cat") == "fork" and event["ph"] == "i"}
+if instants != {"crash", "oversized"}:
+    raise Exception("Wrong failed run events: " + str(instants))
+
+# the stacks of the tested functions are sampled and can be symbolized
+with tempfile.TemporaryDirectory() as directory:
+    process = run("function_test", "--sample-profile", directory, "--sample-rate", "1000")
+    if not os.path.exists(os.path.join(directory, "profile.Spin.stacks")):
+        raise Exception("No samples written")
+    subprocess.run(["python3", "../../tools/symbolize.py", directory], check=True)
+    with open(os.path.join(directory, "profile.Spin.folded")) as f:
+        folded = f.read()
+    if "Spin" not in folded:
+        raise Exception("Tested function not in the samples: " + folded[:1000])
@@ -0,0 +1,16 @@
+#include <vector>
+#include <numeric>
+
+#include <gcheck/function_test.h>
+
+/*
+    Only declares the tested code, which is compiled from STUDENT_SOURCES.
+*/
+
+int Sum(const std::vector<int>& values);
+
+FUNCTIONTEST(harness, Sum, 3, Sum, 3) {
+    std::vector<int> values(GetRunIndex()*5, 2);
+    SetArguments(values);
+    SetReturn(std::accumulate(values.begin(), values.end(), 0));
+}
@@ -0,0 +1,8 @@
+#include <vector>
+
+int Sum(const std::vector<int>& values) {
+    int sum = 0;
+    for(int value : values)
+        sum += value;
+    return sum;
+}
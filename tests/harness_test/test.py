@@ -0,0 +1,19 @@
+#!/usr/bin/env python3
+
+import sys
+import os
+sys.path.insert(1, os.path.join(sys.path[0], '..'))
+sys.path.insert(1, os.path.join(sys.path[0], '../../tools'))
+
+from utils import run, compare
+from report_parser import Report
+
+# built by make with USE_PCH=1 and the tested code in STUDENT_SOURCES
+for path in ["../build/pch/gcheck/tests.h.gch", "../build/student/sum.o"]:
+    if not os.path.exists(path):
+        raise Exception("Not built: " + path)
+
+process = run("harness_test")
+report = Report("report.json")
+
+compare(report, { "harness.Sum": { "points": 3, "max_points": 3 } })
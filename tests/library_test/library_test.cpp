@@ -0,0 +1,345 @@
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <vector>
+#include <thread>
+#include <functional>
+
+#include <gcheck/gcheck.h>
+#include <gcheck/customtest.h>
+#include <gcheck/stringify.h>
+#include <gcheck/binary.h>
+#include <gcheck/intern_table.h>
+#include <gcheck/arena_allocator.h>
+#include <gcheck/multiprocessing.h>
+#include <gcheck/argument.h>
+
+/*
+    Tests of the library internals. Each test passes when everything works as intended.
+*/
+
+namespace {
+    template<typename T>
+    std::string StreamHexFloat(const T& item) {
+        std::stringstream ss;
+        ss << std::hexfloat << item;
+        return ss.str();
+    }
+}
+
+TEST(stringify, floating_point_to_string, 1) {
+    EXPECT_EQ(gcheck::toString(0.5), std::string("0.500000"));
+    EXPECT_EQ(gcheck::toString(-2.5f), std::string("-2.500000"));
+    EXPECT_EQ(gcheck::toString(0.1), std::string("0.100000"));
+    EXPECT_EQ(gcheck::toString(123456.789), std::string("123456.789000"));
+    EXPECT_EQ(gcheck::toString(1.0L), std::string("1.000000"));
+    EXPECT_EQ(gcheck::toString(123456.789f), std::string("123456.789062"));
+    EXPECT_EQ(gcheck::toString(1e300), std::to_string(1e300));
+    // precision lost in six decimals, shortest round-trip form instead
+    EXPECT_EQ(gcheck::toString(1e-7), std::string("1e-07"));
+    EXPECT_EQ(gcheck::toString(1/3.0), std::string("0.3333333333333333"));
+    EXPECT_EQ(gcheck::toString(1/3.0f), std::string("0.33333334"));
+}
+
+TEST(stringify, floating_point_to_construct, 1) {
+    for(double d : {0.0, -0.0, 0.1, -2.5, 1e300, 5e-324, 1/3.0}) {
+        EXPECT_EQ(gcheck::toConstruct(d), StreamHexFloat(d));
+        EXPECT_EQ(gcheck::toConstruct(float(d)), StreamHexFloat(float(d)) + 'f');
+        EXPECT_EQ(gcheck::toConstruct((long double)d), StreamHexFloat((long double)d) + 'l');
+    }
+}
+
+TEST(binary, little_endian, 1) {
+    gcheck::BinaryWriter writer;
+    writer.WriteU32(0x01020304).WriteI64(-2).WriteF64(0.5);
+    EXPECT_EQ(writer.str().substr(0, 4), std::string("\x04\x03\x02\x01"));
+    EXPECT_EQ(writer.str().substr(4, 8), std::string("\xfe\xff\xff\xff\xff\xff\xff\xff"));
+
+    gcheck::BinaryReader reader(writer.str().data(), writer.str().length());
+    EXPECT_EQ(reader.ReadU32(), 0x01020304U);
+    EXPECT_EQ(reader.ReadI64(), -2L);
+    EXPECT_EQ(reader.ReadF64(), 0.5);
+    EXPECT_EQ(reader.Remaining(), 0UL);
+}
+
+TEST(intern, equal_values, 1) {
+    gcheck::InternTable table;
+    size_t a = table.Intern("[1,2,3]"), b = table.Intern("[1,2,3]"), c = table.Intern("[1,2]");
+    EXPECT_EQ(a, b);
+    EXPECT_TRUE(a != c);
+    EXPECT_EQ(table.Size(), 2UL);
+    EXPECT_EQ(table.Entries().at(a).encoded, std::string("[1,2,3]"));
+}
+
+TEST(intern, referred_entries, 1) {
+    gcheck::InternTable table;
+    table.Render("first");
+    size_t a = table.Intern("a");
+    table.Intern("b");
+    table.Render("second");
+    table.Intern("a");
+    EXPECT_EQ(table.Size(), 2UL);
+
+    // rendering again drops the references of the previous rendering
+    table.Render("first");
+    EXPECT_EQ(table.Size(), 1UL);
+    EXPECT_EQ(table.Entries().count(a), 1UL);
+    table.Render("second");
+    EXPECT_EQ(table.Size(), 0UL);
+
+    // a dropped value gets a new id
+    EXPECT_TRUE(table.Intern("a") != a);
+}
+
+TEST(columns, rows_round_trip, 1) {
+    gcheck::FunctionData runs;
+    runs.Resize(4);
+    for(int i : {2, 0, 3, 1}) { // stored out of order like parallel runs
+        gcheck::FunctionEntry e;
+        e.run_time = std::chrono::nanoseconds(10*i);
+        e.timeout = std::chrono::duration<double>(0.5);
+        e.result = i % 2 == 0;
+        e.status = i == 3 ? gcheck::ERROR : gcheck::OK;
+        if(i == 1) {
+            e.arguments = gcheck::UserObject(i);
+            e.max_comparisons = 7;
+            e.operation_counts.emplace().comparisons = 5;
+        }
+        if(i == 2)
+            e.return_value = gcheck::UserObject(std::string("two"));
+        runs.Set(i, e);
+    }
+
+    ASSERT_TRUE(runs.Size() == 4);
+    EXPECT_EQ(runs.Passed(), 2UL);
+    EXPECT_EQ(runs.Count(gcheck::ERROR), 1UL);
+    EXPECT_EQ(runs.TotalRunTime().count(), 60L);
+    EXPECT_EQ(runs.MaxRunTime().count(), 30L);
+    // only the runs that have the payloads store them
+    EXPECT_EQ(runs.objects[5].size(), 1UL);
+    EXPECT_EQ(runs.operation_counts.size(), 4UL);
+    EXPECT_TRUE(runs.io_counts.empty());
+
+    auto first = runs.Get(0), second = runs.Get(1), third = runs.Get(2);
+    EXPECT_TRUE(first.arguments == nullptr);
+    EXPECT_TRUE(first.operation_counts == nullptr);
+    EXPECT_EQ(first.run_time.count(), 0L);
+    EXPECT_EQ(second.arguments->string(), std::string("1"));
+    EXPECT_EQ(*second.max_comparisons, 7UL);
+    EXPECT_EQ(second.operation_counts->comparisons, 5UL);
+    EXPECT_TRUE(second.return_value == nullptr);
+    EXPECT_EQ(third.return_value->string(), std::string("\"two\""));
+    EXPECT_EQ(third.timeout.count(), 0.5);
+    EXPECT_TRUE(runs.Get(3).status == gcheck::ERROR);
+
+    // walking the rows finds the same payloads
+    std::string walked;
+    runs.ForEachRow([&walked](const gcheck::RunColumns::Row& row) {
+        walked += std::to_string(row.run_time.count()) + (row.arguments ? "a" : "") + (row.return_value ? "r" : "") + ",";
+    });
+    EXPECT_EQ(walked, std::string("0,10a,20r,30,"));
+
+    // the runs of all the function reports are summed
+    gcheck::TestData data(1, gcheck::Prerequisite());
+    data.reports.push_back(gcheck::TestReport(runs));
+    data.reports.push_back(gcheck::TestReport(runs));
+    auto summary = data.Runs();
+    EXPECT_EQ(summary.runs, 8UL);
+    EXPECT_EQ(summary.passed, 4UL);
+    EXPECT_EQ(summary.crashed, 2UL);
+}
+
+TEST(arena, scope_and_binding, 1) {
+    // the test itself runs in an arena
+    gcheck::arena_manager* outer = gcheck::arena_manager::manager;
+    EXPECT_TRUE(outer != nullptr);
+
+    // reports go to the current arena, so the results are checked once the scope is over
+    std::vector<int, gcheck::arena_allocator<int>> before;
+    std::optional<std::vector<int, gcheck::arena_allocator<int>>> outlives;
+    bool current, bound, copy_bound, before_bound;
+    {
+        gcheck::arena_manager arena(1024);
+        gcheck::arena_scope scope(arena);
+        current = gcheck::arena_manager::manager == &arena;
+
+        std::vector<int, gcheck::arena_allocator<int>> small(10);
+        bound = small.get_allocator().arena() == &arena;
+        copy_bound = gcheck::arena_allocator<char>(small.get_allocator()).arena() == &arena;
+        before.resize(10000); // keeps the arena it was made in
+        before_bound = before.get_allocator().arena() == outer;
+        outlives.emplace(100);
+    }
+    outlives.reset(); // the arena is gone, freeing its memory is still a no-op
+    EXPECT_TRUE(current);
+    EXPECT_TRUE(bound);
+    EXPECT_TRUE(copy_bound);
+    EXPECT_TRUE(before_bound);
+    EXPECT_TRUE(gcheck::arena_manager::manager == outer);
+    EXPECT_TRUE(gcheck::arena_allocator<int>().arena() == outer);
+}
+
+TEST(records, round_trip_and_oversized, 1) {
+    auto fill = [](gcheck::TestData& data, size_t length) {
+        gcheck::TestReport report = gcheck::TestReport::Make<gcheck::EqualsData>();
+        auto& d = report.Get<gcheck::EqualsData>();
+        d.output_expected = gcheck::UserObject::FromParts("x", gcheck::JSON().Set("[1,2]"), "{1,2}");
+        d.output = gcheck::UserObject::FromParts(std::string(length, 'y'));
+        data.reports.push_back(report);
+    };
+
+    gcheck::TestData small(1, gcheck::Prerequisite());
+    auto status = gcheck::RunForked(std::chrono::duration<double>(0), small, 4096, fill, small, 10);
+    EXPECT_TRUE(status == gcheck::OK);
+    EXPECT_EQ(small.reports.size(), 1UL);
+    if(small.reports.size() == 1) {
+        // the whole UserObject is passed back, not only its string
+        auto& d = small.reports[0].Get<gcheck::EqualsData>();
+        EXPECT_EQ(d.output_expected.json(), gcheck::JSON().Set("[1,2]"));
+        EXPECT_EQ(d.output_expected.string(), std::string("x"));
+        EXPECT_EQ(d.output.string(), std::string(10, 'y'));
+    }
+
+    gcheck::TestData large(1, gcheck::Prerequisite());
+    status = gcheck::RunForked(std::chrono::duration<double>(0), large, 4096, fill, large, 10000);
+    EXPECT_TRUE(status == gcheck::OVERSIZED);
+    EXPECT_EQ(std::string(gcheck::FailureText(status)), std::string("Result too large"));
+    EXPECT_EQ(large.reports.size(), 0UL);
+}
+
+TEST(records, deadline_after_stream_closes, 1) {
+    int stream_fd = -1;
+    std::string stream;
+    gcheck::TestData data(1, gcheck::Prerequisite());
+    auto start = std::chrono::steady_clock::now();
+    auto status = gcheck::RunForkedStreaming(std::chrono::duration<double>(0.2), data, 4096, stream_fd, stream, [&stream_fd]() {
+        write(stream_fd, "partial", 7);
+        close(stream_fd); // the parent sees the end of the stream long before the child exits
+        sleep(10);
+    });
+    EXPECT_TRUE(status == gcheck::TIMEDOUT);
+    EXPECT_EQ(stream, std::string("partial"));
+    EXPECT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
+
+TEST(pool, signal_mask, 1) {
+    auto sigchld_blocked = []() {
+        sigset_t mask;
+        sigprocmask(SIG_SETMASK, NULL, &mask);
+        return sigismember(&mask, SIGCHLD) == 1;
+    };
+    bool before = sigchld_blocked();
+
+    // SIGCHLD is blocked only while there are workers, and not in them
+    gcheck::ForkPool pool(1);
+    gcheck::FunctionEntry entry;
+    pool.Run(std::chrono::duration<double>(5), entry, [&]() { entry.result = sigchld_blocked() == before; }, [](gcheck::ForkStatus) {});
+    bool during = sigchld_blocked();
+    pool.Wait();
+    EXPECT_TRUE(during);
+    EXPECT_TRUE(entry.result);
+    EXPECT_EQ(sigchld_blocked(), before);
+}
+
+TEST(reference, keyed_on_inputs, 1) {
+    const std::string path = "reference_test.cache";
+    int calls = 0;
+    auto square = [&calls](int i) { calls++; return i*i; };
+    auto reference = [this, &square](int i) { return Reference([&]() { return square(i); }, std::to_string(i)); };
+    auto restart = [this]() {
+        reference_calls_.clear();
+        reference_checked_ = false;
+    };
+
+    {
+        gcheck::ReferenceCache record(path, gcheck::ReferenceCache::Record, 1);
+        gcheck::ReferenceCache::cache = &record;
+        for(int i : {1, 2, 3, 2})
+            reference(i);
+        gcheck::ReferenceCache::cache = nullptr;
+        record.Save();
+    }
+
+    // other inputs and order, the first call checks the reference and the new inputs miss
+    restart();
+    calls = 0;
+    gcheck::ReferenceCache replay(path, gcheck::ReferenceCache::Replay, 1);
+    gcheck::ReferenceCache::cache = &replay;
+    int values[] = {reference(2), reference(3), reference(4), reference(2), reference(2)};
+    gcheck::ReferenceCache::cache = nullptr;
+    EXPECT_EQ(values[0], 4);
+    EXPECT_EQ(values[1], 9);
+    EXPECT_EQ(values[2], 16);
+    EXPECT_EQ(values[3], 4);
+    EXPECT_EQ(values[4], 4);
+    EXPECT_EQ(calls, 3); // 2 to check, 4 and the third 2 weren't recorded
+    EXPECT_EQ(replay.Misses(), 2UL);
+    EXPECT_FALSE(replay.Stale());
+
+    // a changed reference isn't trusted for the rest of the values
+    restart();
+    calls = 0;
+    gcheck::ReferenceCache changed(path, gcheck::ReferenceCache::Replay, 1);
+    gcheck::ReferenceCache::cache = &changed;
+    int first = Reference([&calls]() { calls++; return -1; }, "1");
+    int second = reference(3);
+    gcheck::ReferenceCache::cache = nullptr;
+    EXPECT_EQ(first, -1);
+    EXPECT_EQ(second, 9);
+    EXPECT_EQ(calls, 2);
+    EXPECT_TRUE(changed.Stale());
+
+    std::remove(path.c_str());
+}
+
+namespace {
+    // Compares modulo 'base', equal comparators have the same base
+    struct ModuloLess {
+        int base;
+        bool operator()(int a, int b) const { return a % base < b % base; }
+        bool operator==(const ModuloLess& other) const { return base == other.base; }
+    };
+}
+
+TEST(counting, types, 1) {
+    // the counts of the harness itself are not checked, only those between Start and Stop
+    gcheck::OperationCounter::Start();
+    gcheck::CountingContainer<std::set<int, std::greater<int>>> set;
+    for(int i : {1, 3, 2})
+        set.insert(i);
+    gcheck::OperationCounter::Stop();
+    auto counts = gcheck::OperationCounter::Counts();
+    std::vector<int> values(set.begin(), set.end());
+
+    EXPECT_EQ(values, std::vector<int>({3, 2, 1})); // the comparator of the set is kept
+    EXPECT_TRUE(counts.comparisons > 0);
+    EXPECT_EQ(counts.allocations, 3UL);
+    EXPECT_TRUE(gcheck::OperationCounter::Used());
+
+    // nothing is counted outside
+    set.insert(4);
+    EXPECT_EQ(gcheck::OperationCounter::Counts().allocations, 3UL);
+
+    gcheck::CountingComparator<int, ModuloLess> mod3(ModuloLess{3}), mod5(ModuloLess{5});
+    EXPECT_TRUE((mod3 == gcheck::CountingComparator<int, ModuloLess>(ModuloLess{3})));
+    EXPECT_TRUE(mod3 != mod5);
+    EXPECT_TRUE(gcheck::CountingComparator<int>() == gcheck::CountingComparator<int>());
+}
+
+TEST(counting, threads, 1) {
+    gcheck::OperationCounter::Start();
+    std::vector<std::thread> threads;
+    gcheck::CountingComparator<int> less;
+    for(int t = 0; t < 4; t++)
+        threads.emplace_back([&less]() {
+            for(int i = 0; i < 10000; i++)
+                less(i, i + 1);
+        });
+    for(auto& thread : threads)
+        thread.join();
+    gcheck::OperationCounter::Stop();
+
+    EXPECT_EQ(gcheck::OperationCounter::Counts().comparisons, 40000UL);
+}
@@ -0,0 +1,36 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <gcheck/scale_test.h>
+
+std::atomic<size_t> calls = 0;
+
+void Count(size_t threads) {
+    calls += threads;
+}
+
+void Throw(size_t threads) {
+    if(threads > 1)
+        throw std::runtime_error("too many threads");
+}
+
+void Hang() {
+    while(true)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+SCALETEST(scale, Count, Count) {
+    SetThreads({1, 2});
+    SetRepeats(2);
+}
+
+SCALETEST(scale, Throw, Throw, 2) {
+    SetThreads({1, 2});
+}
+
+SCALETEST(scale, Hang, Hang) {
+    SetThreads({1});
+    SetTimeout(0.5);
+}
@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+
+import sys
+import os
+import time
+sys.path.insert(1, os.path.join(sys.path[0], '..'))
+sys.path.insert(1, os.path.join(sys.path[0], '../../tools'))
+
+from utils import run, compare
+from report_parser import Report, Type, ForkStatus
+
+# The hanging test is only stopped by its timeout in the forked run
+start = time.monotonic()
+process = run("scale_test", "--safe")
+if time.monotonic() - start > 30:
+    raise Exception("The timeout of the hanging test wasn't applied")
+report = Report("report.json")
+
+compare(report, {
+    "scale.Count": { "points": 1, "max_points": 1, "results": { "type": Type.SC } },
+    "scale.Throw": { "points": 1, "max_points": 2, "results": { "type": Type.SC } },
+    "scale.Hang": { "points": 0, "max_points": 1, "results": { "type": Type.ET } },
+})
+
+tests = {f"{test.suite}.{test.test}": test for test in report.tests}
+
+levels = tests["scale.Count"].results[0].levels
+if [level.threads for level in levels] != [1, 2]:
+    raise Exception("Wrong levels")
+if any(level.status != ForkStatus.OK or not level.result or level.throughput <= 0 for level in levels):
+    raise Exception("A level of a working function failed")
+
+levels = tests["scale.Throw"].results[0].levels
+if [level.status for level in levels] != [ForkStatus.OK, ForkStatus.ERROR]:
+    raise Exception("Wrong statuses of the levels")
+if "too many threads" not in tests["scale.Throw"].results[0].info:
+    raise Exception("The exception isn't reported")
+
+if tests["scale.Hang"].results[0].descriptor != "Timed out":
+    raise Exception("The timeout isn't reported")
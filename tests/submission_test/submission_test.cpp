@@ -0,0 +1,17 @@
+#include <string>
+
+#include <gcheck/gcheck.h>
+#include <gcheck/function_test.h>
+#include <gcheck/dynamic.h>
+
+/*
+    Graded with --submissions, see test.py. The submissions are built from the sources in submissions/.
+*/
+
+gcheck::Dynamic<int(int)> twice("twice");
+
+FUNCTIONTEST(dynamic, twice, 3, twice, 3) {
+    int i = GetRunIndex() + 1;
+    SetArguments(i);
+    SetReturn(Reference([i]() { return 2*i; }, std::to_string(i)));
+}
@@ -0,0 +1,3 @@
+extern "C" int twice(int i) {
+    return 2*i;
+}
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+
+import sys
+import os
+import shutil
+import subprocess
+import tempfile
+sys.path.insert(1, os.path.join(sys.path[0], '..'))
+sys.path.insert(1, os.path.join(sys.path[0], '../../tools'))
+
+from utils import compare
+from report_parser import Report
+
+def grade(directory, *args):
+    return subprocess.run(["../bin/submission_test", "--submissions", directory, *args], stderr=subprocess.PIPE, text=True)
+
+expect = {
+    "correct": { "dynamic.twice": { "points": 3, "max_points": 3 } },
+    "wrong": { "dynamic.twice": { "points": 0, "max_points": 3 } },
+}
+
+with tempfile.TemporaryDirectory() as directory:
+    for name in expect:
+        shutil.copy(f"../build/submissions/{name}.so", directory)
+    cache = os.path.join(directory, "reference.cache")
+
+    process = grade(directory, "--record-reference", cache)
+    if process.returncode != 0:
+        raise Exception("Recording failed: " + process.stderr)
+    if not os.path.exists(cache):
+        raise Exception("Reference cache was not saved")
+    for name, tests in expect.items():
+        compare(Report(os.path.join(directory, name + ".json")), tests)
+
+    process = grade(directory, "--replay-reference", cache)
+    if process.returncode != 0 or "reference" in process.stderr:
+        raise Exception("Replaying failed: " + process.stderr)
+    for name, tests in expect.items():
+        compare(Report(os.path.join(directory, name + ".json")), tests)
+
+    # the others are still graded, but the exit status tells that one couldn't be
+    with open(os.path.join(directory, "broken.so"), "w") as f:
+        f.write("not a shared object")
+    process = grade(directory)
+    if process.returncode == 0:
+        raise Exception("A submission that failed to load wasn't reported in the exit status")
+    for name, tests in expect.items():
+        compare(Report(os.path.join(directory, name + ".json")), tests)
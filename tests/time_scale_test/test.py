@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+
+import sys
+import os
+import glob
+import tempfile
+import subprocess
+sys.path.insert(1, os.path.join(sys.path[0], '..'))
+sys.path.insert(1, os.path.join(sys.path[0], '../../tools'))
+
+from utils import compare
+from report_parser import Report, Type
+
+expect = {
+    "scaled.Limits": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "scaled.Relative": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+}
+
+def run(env, *args):
+    return subprocess.run(["../bin/time_scale_test", *args], env=env, stdin=subprocess.DEVNULL, stdout=subprocess.PIPE, text=True, check=True)
+
+def check_limits(report, scale):
+    compare(report, expect)
+    if abs(report.time_scale - scale) > 1e-9:
+        raise Exception(f"Wrong time scale {report.time_scale}, expected {scale}")
+    for test in report.tests:
+        case = test.results[0].cases[0]
+        if test.test == "Limits":
+            if abs(case.timeout - 1.5*scale) > 1e-6 or abs(case.max_run_time - 1e9*scale) > 1:
+                raise Exception("The limits aren't scaled")
+        elif case.timeout < 3 or case.timeout > 3.5:
+            raise Exception("The limits relative to the reference are scaled")
+
+with tempfile.TemporaryDirectory() as cache:
+    env = dict(os.environ, XDG_CACHE_HOME=cache)
+
+    # --machine-score measures the host and caches the score
+    score = float(run(env, "--machine-score").stdout)
+    cached = glob.glob(os.path.join(cache, "gcheck", "score-*"))
+    if score <= 0 or len(cached) != 1 or abs(float(open(cached[0]).read()) - score) > score*1e-5:
+        raise Exception("The score isn't cached")
+
+    # The cached score is used, so a host half as fast as the reference of 1000 gets twice the time
+    with open(cached[0], "w") as file:
+        file.write("500\n")
+    run(env, "--json")
+    check_limits(Report("report.json"), 2)
+
+    run(env, "--report-format=bin")
+    check_limits(Report("report.bin"), 2)
+
+    run(env, "--json", "--time-scale", "0.5")
+    check_limits(Report("report.json"), 0.5)
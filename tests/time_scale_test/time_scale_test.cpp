@@ -0,0 +1,20 @@
+#include <gcheck/function_test.h>
+
+GCHECK_REFERENCE_SCORE(1000)
+
+int Identity(int value) {
+    return value;
+}
+
+FUNCTIONTEST(scaled, Limits, 1, Identity, 1) {
+    SetArguments(1);
+    SetReturn(1);
+    SetTimeout(1.5);
+    SetMaxRunTime(1000000000);
+}
+
+FUNCTIONTEST(scaled, Relative, 1, Identity, 1) {
+    SetArguments(1);
+    SetReturn(1);
+    SetRelativeTimeout(Identity, 1000000, std::chrono::seconds(3));
+}
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+import sys
+import os
+import fcntl
+import tempfile
+import subprocess
+sys.path.insert(1, os.path.join(sys.path[0], '..'))
+sys.path.insert(1, os.path.join(sys.path[0], '../../tools'))
+
+from utils import run, compare
+from report_parser import Report, Type
+
+expect = {
+    "timing.Exclusive": { "points": 2, "max_points": 2, "results": { "type": Type.FC, "num_cases": 2 } },
+    "timing.Timed": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "timing.Untimed": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "batch.InPlace": { "points": 2, "max_points": 2, "results": { "type": Type.FC, "num_cases": 2 } },
+    "batch.Return": { "points": 2, "max_points": 2, "results": { "type": Type.FC, "num_cases": 2 } },
+    "calibration.Function": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "calibration.Method": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "warm.Exception": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "warm.Output": { "points": 2, "max_points": 2, "results": { "type": Type.FC, "num_cases": 2 } },
+    "warm.Object": { "points": 2, "max_points": 2, "results": { "type": Type.FC, "num_cases": 2 } },
+    "warm.Counted": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "warm.CountedUnchanged": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "relative.Timed": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "relative.Fast": { "max_points": 1, "results": { "type": Type.FC, "num_cases": 1 } },
+    "relative.Parallel": { "points": 1, "max_points": 1, "results": { "type": Type.FC, "num_cases": 4 } },
+}
+
+def cases(report, id):
+    return [case for test in report.tests if f"{test.suite}.{test.test}" == id for case in test.results[0].cases]
+
+def check_conditions(report):
+    for case in cases(report, "timing.Exclusive"):
+        if case.conditions is None or not case.conditions.pinned or case.conditions.cpu < 0:
+            raise Exception("Exclusive run without its conditions")
+    for case in cases(report, "timing.Timed"):
+        if case.conditions is None or case.conditions.pinned:
+            raise Exception("Wrong conditions of a timed run")
+    for case in cases(report, "timing.Untimed"):
+        if case.conditions is not None:
+            raise Exception("Conditions of an untimed run")
+
+process = run("timing_test")
+report = Report("report.json")
+compare(report, expect)
+check_conditions(report)
+
+for id in ["batch.InPlace", "batch.Return"]:
+    for case in cases(report, id):
+        if case.timer is None or case.timer.batch != 3:
+            raise Exception("Batch not reported")
+
+# The copies of the argument are made in the same way when calibrating, through the method wrapper for METHODTEST
+for id in ["calibration.Function", "calibration.Method"]:
+    for case in cases(report, id):
+        if case.timer.overhead < 1000:
+            raise Exception("Passing the arguments isn't in the overhead of " + id)
+
+# The operations of the warm-up call aren't counted into the timed one
+warm, = cases(report, "warm.Counted")
+unchanged, = cases(report, "warm.CountedUnchanged")
+if warm.cache != "warm" or warm.operations is None or warm.operations.to_dict() != unchanged.operations.to_dict():
+    raise Exception("The warm-up call changed the counts")
+
+fast, = cases(report, "relative.Fast")
+if fast.max_run_time != 0:
+    raise Exception("The max run time relative to an empty function was raised")
+
+for case in cases(report, "relative.Parallel"):
+    if case.max_run_time is None or case.max_run_time < 1000*2000000:
+        raise Exception("The model wasn't timed for a parallel run")
+
+# An exclusive test waits for the lock of its reserved CPU, which another gcheck process could be holding
+cpu = min(os.sched_getaffinity(0))
+with open(os.path.join(tempfile.gettempdir(), f"gcheck-cpu{cpu}.lock"), "a") as lock:
+    fcntl.flock(lock, fcntl.LOCK_EX)
+    process = subprocess.Popen(["../bin/timing_test", "--json", "--pin-cpus", str(cpu)], stdout=subprocess.DEVNULL)
+    try:
+        process.wait(timeout=2)
+        raise Exception("The exclusive test didn't wait for the lock")
+    except subprocess.TimeoutExpired:
+        pass
+    fcntl.flock(lock, fcntl.LOCK_UN)
+if process.wait(timeout=60) != 0:
+    raise Exception("Failed with the lock released")
+
+report = Report("report.json")
+compare(report, expect)
+check_conditions(report)
+for case in cases(report, "timing.Exclusive"):
+    if case.conditions.cpu != cpu:
+        raise Exception("The exclusive test didn't run on the reserved CPU")
+
+if subprocess.run(["../bin/timing_test", "--json", "--pin-cpus", "x"], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL).returncode == 0:
+    raise Exception("An invalid CPU list was accepted")
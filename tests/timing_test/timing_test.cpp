@@ -0,0 +1,196 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gcheck/function_test.h>
+#include <gcheck/method_test.h>
+#include <gcheck/io_test.h>
+#include <gcheck/argument.h>
+
+int Identity(int value) {
+    return value;
+}
+
+FUNCTIONTEST(timing, Exclusive, 2, Identity, 2) {
+    Exclusive();
+    SetArguments(GetRunIndex());
+    SetReturn(GetRunIndex());
+    SetMaxRunTime(1000000000);
+}
+
+FUNCTIONTEST(timing, Timed, 1, Identity, 1) {
+    SetArguments(1);
+    SetReturn(1);
+    SetMaxRunTime(1000000000);
+}
+
+FUNCTIONTEST(timing, Untimed, 1, Identity, 1) {
+    SetArguments(1);
+    SetReturn(1);
+}
+
+void Increment(int& value) {
+    value++;
+}
+
+int Append(std::vector<int>& values) {
+    values.push_back(1);
+    return values.size();
+}
+
+// Each call of the batch changes its own copy of the arguments
+FUNCTIONTEST(batch, InPlace, 2, Increment, 2) {
+    SetBatch(3);
+    SetArguments(1);
+    SetArgumentsAfter(2);
+}
+
+FUNCTIONTEST(batch, Return, 2, Append, 2) {
+    SetBatch(3);
+    SetArguments(std::vector<int>{});
+    SetArgumentsAfter(std::vector<int>{1});
+    SetReturn(1);
+}
+
+// Copying takes a microsecond, which is part of passing it by value and measured as the overhead of the call
+struct SlowCopy {
+    SlowCopy() {}
+    SlowCopy(const SlowCopy&) {
+        auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(1);
+        while(std::chrono::steady_clock::now() < end) {}
+    }
+    SlowCopy& operator=(const SlowCopy&) = default;
+    bool operator==(const SlowCopy&) const { return true; }
+};
+std::string to_string(const SlowCopy&) {
+    return "SlowCopy";
+}
+
+void TakeCopy(SlowCopy) {}
+
+struct Taker {
+    void Take(SlowCopy) {}
+    bool operator==(const Taker&) const { return true; }
+};
+std::string to_string(const Taker&) {
+    return "Taker";
+}
+
+FUNCTIONTEST(calibration, Function, 1, TakeCopy, 1) {
+    SetArguments(SlowCopy());
+    SetMaxRunTime(1000000000);
+}
+
+METHODTEST(calibration, Method, 1, &Taker::Take, 1) {
+    SetObject(new Taker(), true);
+    SetArguments(SlowCopy());
+    SetMaxRunTime(1000000000);
+}
+
+// The warm-up call of the cache mode doesn't change the result of the timed one
+int ThrowFirst(int value) {
+    static bool thrown = false;
+    if(!thrown) {
+        thrown = true;
+        throw std::runtime_error("first call");
+    }
+    return value;
+}
+
+int Echo() {
+    int value;
+    std::cin >> value;
+    std::cout << value << std::endl;
+    return value;
+}
+
+struct Accumulator {
+    int value;
+    int Add(int n) {
+        value += n;
+        return value;
+    }
+    bool operator==(const Accumulator& other) const { return value == other.value; }
+};
+std::string to_string(const Accumulator& accumulator) {
+    return "Accumulator(" + std::to_string(accumulator.value) + ")";
+}
+
+typedef gcheck::CountingContainer<std::vector<int>> CountingVector;
+void Grow(CountingVector& values) {
+    for(int i = 0; i < 100; i++)
+        values.push_back(i);
+}
+
+FUNCTIONTEST(warm, Exception, 1, ThrowFirst, 1) {
+    SetCacheMode(gcheck::Warm);
+    SetArguments(1);
+    SetReturn(1);
+}
+
+IOTEST(warm, Output, 2, Echo, 2) {
+    SetCacheMode(gcheck::Warm);
+    SetInput(std::to_string(GetRunIndex()) + "\n");
+    SetOutput(std::to_string(GetRunIndex()) + "\n");
+    SetReturn(GetRunIndex());
+}
+
+METHODTEST(warm, Object, 2, &Accumulator::Add, 2) {
+    SetCacheMode(gcheck::Warm);
+    SetObject(new Accumulator{1}, true);
+    SetArguments(2);
+    SetReturn(3);
+    SetObjectAfter(new Accumulator{3}, true);
+}
+
+FUNCTIONTEST(warm, Counted, 1, Grow, 1) {
+    SetCacheMode(gcheck::Warm);
+    SetArguments(CountingVector());
+    IgnoreArgumentsAfter();
+}
+
+FUNCTIONTEST(warm, CountedUnchanged, 1, Grow, 1) {
+    SetArguments(CountingVector());
+    IgnoreArgumentsAfter();
+}
+
+// The model of SetRelativeTimeout is called like the tested function, three times
+int model_calls = 0;
+int Model(int value) {
+    model_calls++;
+    return value;
+}
+
+int ModelCalls(int) {
+    return model_calls;
+}
+
+FUNCTIONTEST(relative, Timed, 1, ModelCalls, 1) {
+    SetArguments(1);
+    SetBatch(4);
+    SetCacheMode(gcheck::Warm);
+    SetRelativeTimeout(Model, 1000);
+    SetReturn(3*(1 + 4)); // each warmed up and batched
+}
+
+// Rounds to a max run time of zero, which isn't raised to the resolution of the timing
+FUNCTIONTEST(relative, Fast, 1, Identity) {
+    SetArguments(1);
+    SetReturn(1);
+    SetCacheMode(gcheck::Warm);
+    SetRelativeTimeout(Identity, 0.001);
+}
+
+// The running workers are waited for before the model of each run is timed
+void Sleep(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+FUNCTIONTEST(relative, Parallel, 4, Sleep) {
+    SetArguments(2);
+    SetParallelRuns(2);
+    SetRelativeTimeout(Sleep, 1000);
+}
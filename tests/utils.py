@@ -1,8 +1,8 @@
 import subprocess
 from collections import Counter
 
-def run(binary):
-    return subprocess.run(["../bin/"+binary, "--json"])
+def run(binary, *args):
+    return subprocess.run(["../bin/"+binary, "--json", *args])
 
 def compare_result(result, expected):
     if "type" in expected:
@@ -13,6 +13,11 @@ def compare_result(result, expected):
             print(expected)
             print(result)
             raise Exception("Wrong number of cases")
+    if "statuses" in expected:
+        if expected["statuses"] != [case.status.name for case in result.cases]:
+            print(expected)
+            print(result)
+            raise Exception("Wrong run statuses")
 
 def compare(report, expected):
     testids = [f"{test.suite}.{test.test}" for test in report.tests]
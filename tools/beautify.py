@@ -213,6 +213,13 @@ class Beautify:
         elif result.type == Type.ET or result.type == Type.EF:
             rows = [["correct" if result.result else "incorrect", result.descriptor, *mark_differences(result.value, result.type == Type.ET)]]
             return self.render(self.templates[format], headers=["Result", "Condition", "Value (Output)", "Should be"], rows=rows)
+        elif result.type == Type.SC:
+            rows = []
+            for level in result.levels:
+                target = "" if level.target_speedup is None else f"{level.target_speedup:.2f}"
+                rows.append(["Crashed" if level.status == ForkStatus.ERROR else "correct" if level.result else "incorrect",
+                        level.threads, level.run_time, f"{level.throughput:.4g}", f"{level.speedup:.2f}", f"{level.efficiency:.2f}", target])
+            return self.render(self.templates[format], headers=["Result", "Threads", "Run time", "Throughput", "Speedup", "Efficiency", "Target speedup"], rows=rows)
         elif result.type == Type.FC:
             all_keys = ["run_time", "max_run_time",
                     "object", "object_after", "object_after_expected",
@@ -240,6 +247,8 @@ class Beautify:
                     rows.append([f"Timed out (max time: {case.timeout})"])
                 elif case.status == ForkStatus.ERROR:
                     rows.append(["Crashed"])
+                elif case.status == ForkStatus.OVERSIZED:
+                    rows.append(["Result too large"])
                 else:
                     data = {d[0]: d[1] for p in diff_pairs for d in zip(p, mark_differences(getattr(case, p[0]), getattr(case, p[1])))}
                     data.update({key: getattr(case, key) for key in keys if key not in data})
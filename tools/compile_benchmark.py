@@ -0,0 +1,131 @@
+#!/usr/bin/python3
+"""
+Measures how long building a test executable for one submission takes when
+ - the tests and the submission are compiled together (full),
+ - the library headers are precompiled (pch) and
+ - the tests are compiled once and only the submission is compiled and linked (submission).
+The library has to be built first with 'make static'.
+With --suites, measures compiling each of the test suites in tests/ and the size of the object instead.
+"""
+import argparse
+import os
+import shlex
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+root = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--cxx", dest='cxx', type=str, default=os.environ.get("CXX", "g++"))
+parser.add_argument("--cxxflags", dest='cxxflags', type=str, default="", help="extra compiler flags")
+parser.add_argument("-n", dest='repeat', type=int, default=3, help="number of builds per measurement")
+parser.add_argument("--suites", dest='suites', action="store_true", help="measure the test suites in tests/")
+args = parser.parse_args()
+
+tests = """
+#include <gcheck/gcheck.h>
+#include <gcheck/function_test.h>
+#include <gcheck/io_test.h>
+#include <gcheck/customtest.h>
+#include "submission.h"
+
+FUNCTIONTEST(bench, twice, 10, twice) {
+    SetArguments((int)GetRunIndex());
+    SetReturn(2*(int)GetRunIndex());
+}
+FUNCTIONTEST(bench, join, 10, join) {
+    SetArguments(std::vector<std::string>{"a", "b"}, std::string(","));
+    SetReturn("a,b");
+}
+IOTEST(bench, echo, 10, echo) {
+    SetInput("line\\n");
+    SetOutput("line\\n");
+}
+TEST(bench, compare) {
+    gcheck::Random<double> rnd(0, 1, 1);
+    CompareWithCallable(10, [](double d) { return d/2; }, half, rnd);
+}
+"""
+
+header = """
+#include <string>
+#include <vector>
+int twice(int a);
+std::string join(std::vector<std::string> v, std::string sep);
+void echo();
+double half(double d);
+"""
+
+submission = """
+#include "submission.h"
+#include <iostream>
+int twice(int a) { return 2*a; }
+std::string join(std::vector<std::string> v, std::string sep) {
+    std::string s;
+    for(size_t i = 0; i < v.size(); i++) s += (i ? sep : "") + v[i];
+    return s;
+}
+void echo() { std::string s; std::getline(std::cin, s); std::cout << s << std::endl; }
+double half(double d) { return d/2; }
+"""
+
+def run(command, cwd):
+    result = subprocess.run(command, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if result.returncode != 0:
+        print(" ".join(command))
+        print(result.stdout)
+        sys.exit(1)
+
+def measure(commands, cwd):
+    times = []
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        for command in commands:
+            run(command, cwd)
+        times.append(time.perf_counter() - start)
+    return statistics.median(times)
+
+def measure_suites():
+    tests_dir = os.path.join(root, "tests")
+    with tempfile.TemporaryDirectory() as dir:
+        for suite in sorted(os.listdir(tests_dir)):
+            source = os.path.join(tests_dir, suite, suite + ".cpp")
+            if not os.path.isfile(source):
+                continue
+            object = os.path.join(dir, suite + ".o")
+            cxx = [args.cxx, "-std=c++17", "-I" + os.path.join(root, "include")] + shlex.split(args.cxxflags)
+            seconds = measure([cxx + ["-c", source, "-o", object]], dir)
+            print("{:<20}{:8.2f} s{:12d} bytes".format(suite, seconds, os.path.getsize(object)))
+
+if args.suites:
+    measure_suites()
+    sys.exit(0)
+
+with tempfile.TemporaryDirectory() as dir:
+    os.makedirs(os.path.join(dir, "pch", "gcheck"))
+    with open(os.path.join(dir, "tests.cpp"), "w") as f:
+        f.write(tests)
+    with open(os.path.join(dir, "submission.h"), "w") as f:
+        f.write(header)
+    with open(os.path.join(dir, "submission.cpp"), "w") as f:
+        f.write(submission)
+    with open(os.path.join(dir, "combined.cpp"), "w") as f:
+        f.write(submission + tests)
+
+    cxx = [args.cxx, "-std=c++17", "-I" + os.path.join(root, "include")] + shlex.split(args.cxxflags)
+    link = ["-L" + os.path.join(root, "lib"), "-lgcheck"]
+    pch = ["-I" + os.path.join(dir, "pch"), "-include", "gcheck/tests.h"]
+
+    results = [
+        ("full", measure([cxx + ["combined.cpp"] + link + ["-o", "full"]], dir)),
+        ("pch header (once)", measure([cxx + ["-x", "c++-header", os.path.join(root, "include", "gcheck", "tests.h"), "-o", "pch/gcheck/tests.h.gch"]], dir)),
+        ("pch", measure([cxx[:1] + pch + cxx[1:] + ["combined.cpp"] + link + ["-o", "full_pch"]], dir)),
+        ("harness (once)", measure([cxx + ["-c", "tests.cpp", "-o", "tests.o"]], dir)),
+        ("submission", measure([cxx + ["-c", "submission.cpp", "-o", "submission.o"], cxx + ["tests.o", "submission.o"] + link + ["-o", "submission"]], dir)),
+    ]
+
+    for name, seconds in results:
+        print("{:<20}{:8.2f} s".format(name, seconds))
@@ -1,4 +1,8 @@
 import json
+import mmap
+import os
+import struct
+import codecs
 from enum import Enum
 from typing import Union
 
@@ -40,11 +44,13 @@ class Type(Enum):
     EE = 3
     EF = 4
     ET = 5
+    SC = 6
 
 class ForkStatus(Enum):
     OK = 1
     TIMEDOUT = 2
     ERROR = 3
+    OVERSIZED = 4
 
 class Status(Enum):
     NotStarted = 1
@@ -58,6 +64,37 @@ class UserObject(Dictifiable):
         self.string = report["string"]
         self.construct = report.get("construct", None)
 
+class IOCounts(Dictifiable):
+    def __init__(self, report):
+        self.read_calls = report["read_calls"]
+        self.write_calls = report["write_calls"]
+        self.read_bytes = report["read_bytes"]
+        self.written_bytes = report["written_bytes"]
+
+class OperationCounts(Dictifiable):
+    def __init__(self, report):
+        self.comparisons = report["comparisons"]
+        self.dereferences = report["dereferences"]
+        self.copies = report["copies"]
+        self.moves = report["moves"]
+        self.allocations = report["allocations"]
+
+class TimingConditions(Dictifiable):
+    def __init__(self, report):
+        self.cpu = report["cpu"]
+        self.governor = report["governor"]
+        self.frequency = report["frequency"]
+        self.load = report["load"]
+        self.preemptions = report["preemptions"]
+        self.pinned = report["pinned"]
+        self.noisy = report["noisy"]
+
+class TimerInfo(Dictifiable):
+    def __init__(self, report):
+        self.overhead = report["overhead"]
+        self.resolution = report["resolution"]
+        self.batch = report["batch"]
+
 class FunctionEntry(Dictifiable):
     def __init__(self, report):
         self.result = report["result"]
@@ -82,6 +119,15 @@ class FunctionEntry(Dictifiable):
         self.object_after_expected = UO_or_None("object_after_expected")
         self.max_run_time = or_None("max_run_time")
         self.run_time = or_None("run_time")
+        self.io = IOCounts(report["io"]) if "io" in report else None
+        self.max_read_calls = or_None("max_read_calls")
+        self.max_write_calls = or_None("max_write_calls")
+        self.operations = OperationCounts(report["operations"]) if "operations" in report else None
+        self.max_comparisons = or_None("max_comparisons")
+        self.max_allocations = or_None("max_allocations")
+        self.conditions = TimingConditions(report["conditions"]) if "conditions" in report else None
+        self.timer = TimerInfo(report["timer"]) if "timer" in report else None
+        self.cache = or_None("cache")
         self.timeout = or_None("timeout")
         self.status = ForkStatus[report["status"]]
 
@@ -98,6 +144,26 @@ class CaseEntry(Dictifiable):
         self.input = UO_or_None("input")
         self.arguments = UO_or_None("arguments")
 
+class RunSummary(Dictifiable):
+    def __init__(self, report):
+        self.runs = report["runs"]
+        self.passed = report["passed"]
+        self.timed_out = report["timed_out"]
+        self.crashed = report["crashed"]
+        self.total_run_time = report["total_run_time"]
+        self.max_run_time = report["max_run_time"]
+
+class ScaleEntry(Dictifiable):
+    def __init__(self, report):
+        self.threads = report["threads"]
+        self.run_time = report["run_time"]
+        self.throughput = report["throughput"]
+        self.speedup = report["speedup"]
+        self.efficiency = report["efficiency"]
+        self.target_speedup = report.get("target_speedup")
+        self.status = ForkStatus[report["status"]]
+        self.result = report["result"]
+
 class Result(Dictifiable):
     def __init__(self, report):
         self.type = Type[report["type"]]
@@ -106,6 +172,8 @@ class Result(Dictifiable):
             self.cases = [FunctionEntry(r) for r in report["cases"]]
         elif self.type ==  Type.TC:
             self.cases = [CaseEntry(r) for r in report["cases"]]
+        elif self.type == Type.SC:
+            self.levels = [ScaleEntry(r) for r in report["levels"]]
         elif self.type in [Type.EE, Type.EF, Type.ET]:
             self.result = report["result"]
             self.descriptor = report["descriptor"]
@@ -130,25 +198,290 @@ class Test(Dictifiable):
         self.status = Status[report["status"]]
         self.results = [Result(r) for r in report["results"]]
         self.prerequisite = Prerequisite(report["prerequisite"])
+        self.run_summary = RunSummary(report["run_summary"]) if "run_summary" in report else None
 
     def get_name(self):
         return self.suite + " : " + self.test
 
+BINARY_MAGIC = b"GCHECKB\0"
+BINARY_VERSION = 12
+BINARY_INTERNED = 1
+BINARY_PROFILED = 2
+
+def _raw_bytes(error):
+    # Same as JSONEscape on the C++ side: bytes that aren't valid utf-8 map to the code point of the same value
+    return ("".join(chr(b) for b in error.object[error.start:error.end]), error.end)
+
+codecs.register_error("gcheck_raw", _raw_bytes)
+
+class BinaryReader:
+    """Decodes a binary report (--report-format=bin) into the same dictionaries json.load gives for a JSON report"""
+    _u8 = struct.Struct("<B")
+    _u16 = struct.Struct("<H")
+    _u32 = struct.Struct("<I")
+    _i32 = struct.Struct("<i")
+    _i64 = struct.Struct("<q")
+    _f64 = struct.Struct("<d")
+
+    report_types = ["EE", "ET", "EF", "TC", "FC", "SC"]
+    test_statuses = ["NotStarted", "Started", "TimedOut", "Finished"]
+    fork_statuses = ["OK", "TIMEDOUT", "ERROR", "OVERSIZED"]
+    cache_modes = [None, "cold", "warm"]
+    governors = ["unknown", "performance", "powersave", "ondemand", "conservative", "schedutil", "userspace", "other"]
+    case_fields = ["input", "output", "output_expected", "arguments"]
+    function_fields = [
+        "input", "output", "output_expected", "error", "error_expected",
+        "arguments", "arguments_after", "arguments_after_expected",
+        "return_value", "return_value_expected",
+        "object", "object_after", "object_after_expected"
+    ]
+
+    def __init__(self, buffer, pos = 0):
+        self.buffer = buffer
+        self.pos = pos
+        self.interned = None
+
+    def _unpack(self, s):
+        value = s.unpack_from(self.buffer, self.pos)[0]
+        self.pos += s.size
+        return value
+
+    def u8(self):
+        return self._unpack(self._u8)
+    def u16(self):
+        return self._unpack(self._u16)
+    def u32(self):
+        return self._unpack(self._u32)
+    def i32(self):
+        return self._unpack(self._i32)
+    def i64(self):
+        return self._unpack(self._i64)
+    def f64(self):
+        return self._unpack(self._f64)
+    def bool(self):
+        return self.u8() != 0
+
+    def string(self):
+        length = self.u32()
+        value = self.buffer[self.pos:self.pos+length].decode("utf-8", "gcheck_raw")
+        self.pos += length
+        return value
+
+    def header(self):
+        magic = self.buffer[self.pos:self.pos+len(BINARY_MAGIC)]
+        self.pos += len(BINARY_MAGIC)
+        if magic != BINARY_MAGIC:
+            raise ValueError("Not a gcheck binary report")
+        version = self.u32()
+        if version != BINARY_VERSION:
+            raise ValueError(f"Unsupported binary report version {version}")
+        return self.u32()
+
+    def intern_table(self):
+        # the values are decoded when they are first referred to
+        self.interned = {}
+        for _ in range(self.u32()):
+            id = self.u32()
+            length = self.u32()
+            self.interned[id] = self.pos
+            self.pos += length
+
+    def user_object(self):
+        if self.interned is None:
+            return self.inline_user_object()
+
+        id = self.u32()
+        value = self.interned[id]
+        if isinstance(value, int):
+            pos = self.pos
+            self.pos = value
+            value = self.interned[id] = self.inline_user_object()
+            self.pos = pos
+        return value
+
+    def inline_user_object(self):
+        text = self.string()
+        try:
+            value = json.loads(text)
+        except ValueError:
+            value = text
+        d = {"json": value, "string": self.string()}
+        if self.bool():
+            d["construct"] = self.string()
+        return d
+
+    def _optional_fields(self, d, fields, mask):
+        for i, field in enumerate(fields):
+            if mask & (1 << i):
+                d[field] = self.user_object()
+
+    def case_entry(self):
+        d = {}
+        self._optional_fields(d, self.case_fields, self.u8())
+        d["result"] = self.bool()
+        return d
+
+    def function_entry(self):
+        d = {}
+        self._optional_fields(d, self.function_fields, self.u16())
+        if self.bool():
+            d["max_run_time"] = self.i64()
+        d["run_time"] = self.i64()
+        if self.bool():
+            d["io"] = {key: self.i64() for key in ["read_calls", "write_calls", "read_bytes", "written_bytes"]}
+        if self.bool():
+            d["operations"] = {key: self.i64() for key in ["comparisons", "dereferences", "copies", "moves", "allocations"]}
+        for key in ["max_read_calls", "max_write_calls", "max_comparisons", "max_allocations"]:
+            if self.bool():
+                d[key] = self.i64()
+        if self.bool():
+            d["conditions"] = {"cpu": self.i32(), "governor": self.governors[self.u8()], "frequency": self.u32(),
+                    "load": self.f64(), "preemptions": self.i64(), "pinned": self.bool(), "noisy": self.bool()}
+        if self.bool():
+            d["timer"] = {"overhead": self.i64(), "resolution": self.i64(), "batch": self.u32()}
+        cache = self.u8()
+        if cache != 0:
+            d["cache"] = self.cache_modes[cache]
+        d["timeout"] = self.f64()
+        d["status"] = self.fork_statuses[self.u8()]
+        d["result"] = self.bool()
+        return d
+
+    def scale_entry(self):
+        d = {"threads": self.u32(), "run_time": self.i64(), "throughput": self.f64(), "speedup": self.f64(), "efficiency": self.f64()}
+        if self.bool():
+            d["target_speedup"] = self.f64()
+        d["status"] = self.fork_statuses[self.u8()]
+        d["result"] = self.bool()
+        return d
+
+    def result(self):
+        type = self.report_types[self.u8()]
+        d = {"type": type, "info": self.string()}
+        if type == "EE":
+            # only the strings are in the JSON reports
+            d["output_expected"] = self.user_object()["string"]
+            d["output"] = self.user_object()["string"]
+            d["result"] = self.bool()
+            d["descriptor"] = self.string()
+        elif type in ["ET", "EF"]:
+            d["value"] = self.bool()
+            d["result"] = self.bool()
+            d["descriptor"] = self.string()
+        elif type == "TC":
+            d["cases"] = [self.case_entry() for _ in range(self.u32())]
+        elif type == "FC":
+            d["cases"] = [self.function_entry() for _ in range(self.u32())]
+        elif type == "SC":
+            d["levels"] = [self.scale_entry() for _ in range(self.u32())]
+        return d
+
+    def prerequisite(self):
+        d = {"isfullfilled": self.bool()}
+        d["details"] = [{"suite": self.string(), "test": self.string(), "isfullfilled": self.bool()} for _ in range(self.u32())]
+        return d
+
+    def test(self):
+        d = {}
+        d["status"] = self.test_statuses[self.u8()]
+        d["grading_method"] = self.u8()
+        d["points"] = self.f64()
+        d["max_points"] = self.f64()
+        d["correct"] = self.i32()
+        d["incorrect"] = self.i32()
+        d["format"] = self.string()
+        d["stdout"] = self.string()
+        d["stderr"] = self.string()
+        d["prerequisite"] = self.prerequisite()
+        d["results"] = [self.result() for _ in range(self.u32())]
+        summary = self.run_summary()
+        if summary["runs"] != 0:
+            d["run_summary"] = summary
+        return d
+
+    def run_summary(self):
+        d = {}
+        d["runs"] = self.u32()
+        d["passed"] = self.u32()
+        d["timed_out"] = self.u32()
+        d["crashed"] = self.u32()
+        d["total_run_time"] = self.i64()
+        d["max_run_time"] = self.i64()
+        return d
+
+    def report(self):
+        flags = self.header()
+        d = {"points": self.f64(), "max_points": self.f64(), "time_scale": self.f64(), "test_results": {}}
+        if flags & BINARY_INTERNED:
+            self.intern_table()
+        for _ in range(self.u32()):
+            suite = d["test_results"].setdefault(self.string(), {})
+            for _ in range(self.u32()):
+                name = self.string()
+                self.u32() # length of the test record
+                suite[name] = self.test()
+        if flags & BINARY_PROFILED:
+            d["harness_profile"] = self.harness_profile()
+        return d
+
+    def profile_times(self):
+        return {self.string(): self.i64() for _ in range(self.u32())}
+
+    def harness_profile(self):
+        d = {"total": self.profile_times(), "tests": {}}
+        for _ in range(self.u32()):
+            suite = d["tests"].setdefault(self.string(), {})
+            for _ in range(self.u32()):
+                name = self.string()
+                suite[name] = self.profile_times()
+        return d
+
+def load_report(filename):
+    """Loads a JSON or binary report into a dictionary. The format is detected from the file contents."""
+    if os.path.getsize(filename) >= len(BINARY_MAGIC):
+        with open(filename, 'rb') as f:
+            with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as m:
+                if m[:len(BINARY_MAGIC)] == BINARY_MAGIC:
+                    return BinaryReader(m).report()
+
+    with open(filename, 'r') as f:
+        return resolve_interned(json.load(f))
+
+def resolve_interned(data):
+    """Replaces the references to the "interned" table of a deduplicated JSON report with the values"""
+    if "interned" not in data:
+        return data
+
+    table = data.pop("interned")
+    def resolve(value):
+        if isinstance(value, dict):
+            if len(value) == 1 and "interned" in value:
+                return table[str(value["interned"])]
+            return {key: resolve(item) for key, item in value.items()}
+        if isinstance(value, list):
+            return [resolve(item) for item in value]
+        return value
+    data["test_results"] = resolve(data["test_results"])
+    return data
+
 class Report(Dictifiable):
     points = 0
     max_points = 0
     def __init__(self, filename = None):
         if filename is not None:
-            with open(filename, 'r') as f:
-                self.data = json.load(f)
-                self.points = self.data["points"]
-                self.max_points = self.data["max_points"]
-                self.tests = [Test(suite_name, test_name, test_data) for suite_name, suite_data in self.data["test_results"].items() for test_name, test_data in suite_data.items()]
+            self.data = load_report(filename)
+            self.points = self.data["points"]
+            self.max_points = self.data["max_points"]
+            self.tests = [Test(suite_name, test_name, test_data) for suite_name, suite_data in self.data["test_results"].items() for test_name, test_data in suite_data.items()]
+            self.harness_profile = self.data.get("harness_profile")
+            self.time_scale = self.data.get("time_scale", 1)
         else:
             self.data = {}
             self.points = 0
             self.max_points = 0
             self.tests = []
+            self.harness_profile = None
+            self.time_scale = 1
 
     def get_json(self):
         return json.dumps(self.data)
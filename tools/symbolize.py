@@ -0,0 +1,166 @@
+#!/usr/bin/python3
+"""
+Turns the samples written with --sample-profile <directory> into folded stacks,
+one <suite>.<test>.folded next to each <suite>.<test>.stacks, e.g.
+    flamegraph.pl directory/suite.test.folded > suite.test.svg
+The files can also be opened in speedscope. Needs addr2line from binutils.
+The binaries and shared objects have to be the ones that were profiled.
+"""
+import argparse
+import bisect
+import glob
+import os
+import struct
+import subprocess
+import sys
+from collections import defaultdict
+
+parser = argparse.ArgumentParser()
+parser.add_argument("directory", type=str)
+parser.add_argument("--addresses", dest='addresses', action="store_true", help="keep the unresolved addresses in the frames")
+args = parser.parse_args()
+
+class Mapping:
+    def __init__(self, start, end, offset, path):
+        self.start = start
+        self.end = end
+        self.offset = offset
+        self.path = path
+
+def read_maps(filename):
+    maps = []
+    with open(filename) as f:
+        for line in f:
+            parts = line.split(maxsplit=5)
+            if len(parts) < 6 or 'x' not in parts[1]:
+                continue
+            start, end = (int(v, 16) for v in parts[0].split('-'))
+            maps.append(Mapping(start, end, int(parts[2], 16), parts[5].strip()))
+    maps.sort(key=lambda m: m.start)
+    return maps
+
+elf_cache = {}
+def elf_info(path):
+    """Returns (is position independent, [(offset, vaddr, size)] of the loadable segments)"""
+    if path in elf_cache:
+        return elf_cache[path]
+    info = None
+    try:
+        with open(path, "rb") as f:
+            header = f.read(64)
+            if header[:4] == b"\x7fELF" and header[4] == 2: # 64-bit
+                end = "<" if header[5] == 1 else ">"
+                e_type, = struct.unpack_from(end + "H", header, 16)
+                e_phoff, = struct.unpack_from(end + "Q", header, 32)
+                e_phentsize, e_phnum = struct.unpack_from(end + "HH", header, 54)
+                segments = []
+                for i in range(e_phnum):
+                    f.seek(e_phoff + i*e_phentsize)
+                    p_type, _, p_offset, p_vaddr, _, p_filesz = struct.unpack(end + "IIQQQQ", f.read(40))
+                    if p_type == 1: # PT_LOAD
+                        segments.append((p_offset, p_vaddr, p_filesz))
+                info = (e_type == 3, segments) # ET_DYN
+    except OSError:
+        pass
+    elf_cache[path] = info
+    return info
+
+def file_address(mapping, address):
+    """The address addr2line expects for 'address' in 'mapping', or None"""
+    info = elf_info(mapping.path)
+    if info is None:
+        return None
+    dynamic, segments = info
+    if not dynamic:
+        return address
+    offset = address - mapping.start + mapping.offset
+    for p_offset, p_vaddr, p_filesz in segments:
+        if p_offset <= offset < p_offset + p_filesz:
+            return offset - p_offset + p_vaddr
+    return offset
+
+def addr2line(path, addresses):
+    if not addresses:
+        return {}
+    out = subprocess.run(["addr2line", "-f", "-C", "-e", path] + [hex(a) for a in addresses],
+                         capture_output=True, text=True).stdout.splitlines()
+    return {a: out[2*i] for i, a in enumerate(addresses) if 2*i < len(out) and out[2*i] != "??"}
+
+def read_stacks(filename):
+    """Returns [(maps pid, [addresses], count)]"""
+    stacks = []
+    maps = None
+    with open(filename) as f:
+        for line in f:
+            if line.startswith("# maps "):
+                maps = line.split()[2]
+            elif line.startswith("# dropped "):
+                print(filename + ": " + line.split()[2] + " samples dropped, the buffer was full", file=sys.stderr)
+            elif line.strip():
+                frames, count = line.rsplit(maxsplit=1)
+                stacks.append((maps, [int(a, 16) for a in frames.split(';')], int(count)))
+    return stacks
+
+def symbolize(filename):
+    stacks = read_stacks(filename)
+
+    # Every address is resolved once, with one addr2line call per object
+    lookups = defaultdict(set) # path -> file addresses
+    frames = {} # (maps pid, address, is return address) -> (path, file address) or name
+    for pid, addresses, _ in stacks:
+        if pid not in maps_cache:
+            maps_cache[pid] = read_maps(os.path.join(args.directory, "maps." + pid))
+        maps = maps_cache[pid]
+        starts = [m.start for m in maps]
+        for i, address in enumerate(addresses):
+            # All but the innermost frame are return addresses, the call is the instruction before
+            key = (pid, address, i != len(addresses) - 1)
+            if key in frames:
+                continue
+            index = bisect.bisect_right(starts, address) - 1
+            if index < 0 or address >= maps[index].end:
+                frames[key] = "[unknown]"
+                continue
+            mapping = maps[index]
+            if not mapping.path.startswith('/'):
+                frames[key] = mapping.path or "[anonymous]"
+                continue
+            location = file_address(mapping, address - 1 if key[2] else address)
+            if location is None:
+                frames[key] = "[" + os.path.basename(mapping.path) + "]"
+                continue
+            frames[key] = (mapping.path, location)
+            lookups[mapping.path].add(location)
+
+    names = {path: addr2line(path, sorted(addresses)) for path, addresses in lookups.items()}
+
+    def name(key):
+        frame = frames[key]
+        if isinstance(frame, str):
+            return frame
+        path, location = frame
+        resolved = names[path].get(location)
+        if resolved is None:
+            return os.path.basename(path) + "+" + hex(location)
+        return resolved + (" [" + hex(location) + "]" if args.addresses else "")
+
+    folded = defaultdict(int)
+    for pid, addresses, count in stacks:
+        symbols = [name((pid, a, i != len(addresses) - 1)) for i, a in enumerate(addresses)]
+        # ';' separates the frames in the folded format
+        folded[";".join(s.replace(";", ":") for s in symbols)] += count
+
+    output = filename[:-len(".stacks")] + ".folded"
+    with open(output, "w") as f:
+        for stack, count in sorted(folded.items()):
+            f.write(stack + " " + str(count) + "\n")
+    return output, sum(folded.values())
+
+maps_cache = {}
+files = sorted(glob.glob(os.path.join(args.directory, "*.stacks")))
+if not files:
+    print("error: no samples in " + args.directory, file=sys.stderr)
+    sys.exit(1)
+for filename in files:
+    output, samples = symbolize(filename)
+    print(output + ": " + str(samples) + " samples")